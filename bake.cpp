@@ -1,21 +1,41 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <vector>
 #include <set>
 #include <map>
+#include <algorithm>
+#include <functional>
 #include <stdlib.h>
+#include <limits.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <signal.h>
+#include <string.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include "bake.h"
 
 typedef std::string            String;
 typedef std::set<String>       SetS;
 typedef std::set<int>          SetI;
+typedef std::vector<int>       VecI;
 typedef std::vector<String>    VecS;
 typedef std::vector<VecS>      VecVecS;
 typedef std::map<int, String>  MapIS;
 typedef std::map<String, VecS> MapSV;
+typedef std::map<String, double> MapSD;
+typedef std::map<String, String> MapSS;
 
 // Globals
 VecS args;
@@ -24,6 +44,7 @@ MapSV variables;
 VecS inclDirs;
 String RecipeName;
 String Prefix;
+String StateDir = ".bake";
 
 /////////////
 // Helpers //
@@ -32,6 +53,9 @@ String Prefix;
 // Max
 int Max(int a, int b);
 
+// Abort Run (Exits, or Throws bake::Error When Embedded)
+void Abort() __attribute__((noreturn));
+
 // Join Paths
 String Join(const String& a, const String& b);
 
@@ -44,6 +68,9 @@ String GetDir(const String& path);
 // Concatenate VecS
 String Concat(const VecS& vecS);
 
+// Split on Delimiter
+VecS SplitOn(const String& str, char delim);
+
 // Concatenate SetS
 String Concat(const SetS& setS);
 
@@ -56,6 +83,9 @@ String ToStr(const SetS& setS);
 // Ends-With
 bool EndsWith(const String& str, const String& ending);
 
+// Starts-With
+bool StartsWith(const String& str, const String& start);
+
 // File-Exists
 bool FileExists(const String& path);
 
@@ -65,6 +95,9 @@ int GetFileModTm(const String& filename);
 // File Modification Date
 int GetFileModTm(const SetS& filenames);
 
+// File Modification Date (Path Ids)
+int GetFileModTm(const VecI& files);
+
 // Is Option On
 bool IsOn(const String& key);
 
@@ -83,11 +116,29 @@ VecS GetVals(const String& key);
 // Get Multiple Values from Recipe
 VecVecS GetValsM(const String& key);
 
-// Get Set of Direct Includes
-SetS GetIncls(const String& file);
+// Has Value in Recipe
+bool HasVal(const String& key);
+
+// Get Value from Recipe (With Default)
+String GetValOr(const String& key, const String& def);
+
+// Get Absolute Path
+String AbsPath(const String& path);
+
+// Compiler Flags With Path Arguments Made Absolute (False When Other Arguments Name Relative Paths)
+bool AbsFlags(const String& flags, String& absFlags);
+
+// Shared Library Name for Archive
+String SharedLibName(const String& arcName);
 
-// Get Set of Direct and Implied Includes
-SetS GetAllIncls(const String& file);
+// Update Stamp File (Rewritten Only When Content Changes; Only Planning, Planned as Missing Instead)
+void UpdateStamp(const String& file, const String& content);
+
+// Get Direct Includes (Path Ids, Sorted, Scanned Once)
+const VecI& GetIncls(int file);
+
+// Get Direct and Implied Includes (Path Ids, Sorted)
+void GetAllIncls(int file, VecI& result);
 
 // Make-Directory
 void MkDir(const String& dir);
@@ -95,8 +146,14 @@ void MkDir(const String& dir);
 // Chop-Ending
 String ChopEnd(const String& str, int end);
 
-// Spawn Set of Commands
-void Spawn(const VecS& cmds, int nSpawn);
+// Flatten Path Into One File Name
+String FlatName(const String& path);
+
+// Read Whole File
+String ReadFile(const String& path);
+
+// Write Whole File
+bool WriteFile(const String& path, const String& data);
 
 // List Files in a Directory
 VecS ListFiles(const String& dir);
@@ -126,1224 +183,8833 @@ String Star();
 // Display
 void Display(const String& label, const String& target, const String& detail);
 
+// Path Table (Paths Interned Once in a Block Arena, With Dense Integer Ids)
+struct PathTable
+{
+	std::vector<char*>       blocks;  // Arena Blocks
+	size_t                   used;    // Bytes Used in the Last Block
+	std::vector<const char*> paths;   // Path by Id
+	std::vector<unsigned>    hashes;  // Hash by Id
+	std::vector<int>         slots;   // Open-Addressed Index (Id + 1, 0 When Empty)
+
+	// Per-Path Data (By Id)
+	std::vector<int>  modTm;    // Modification Time (0 When Not a File)
+	std::vector<char> isFile;   // Regular File
+	std::vector<int>  statGen;  // Stat Generation (Stale When Behind)
+	std::vector<VecI> incls;    // Direct Includes (Sorted)
+	std::vector<char> scanned;  // Includes Scanned
+	std::vector<int>  mark;     // Visit Mark (Include Closure Walks)
+	std::vector<int>  sameTm;   // Time the Token Stream Last Changed (Fingerprint Mode, 0 When Unknown)
+
+	PathTable();
+	~PathTable();
+
+	// Intern Path (Returns Id)
+	int Intern(const String& path);
+
+	// Path of Id
+	const char* Path(int id) const { return paths[id]; }
+
+	// Number of Paths
+	int Size() const { return paths.size(); }
+
+	// Swap Tables
+	void Swap(PathTable& other);
+};
+
+// Paths
+PathTable Paths;
+
+// Stat Generation (Bumped Whenever Files May Have Changed)
+int StatGeneration = 1;
+
+// Path Id (Interned)
+int PathId(const String& path);
+
+// Path of Id
+String PathStr(int id);
+
+// Stat Path (Cached Until the Generation Changes)
+void StatPath(int id);
+
+// Forget Cached Stats (Files Were Written)
+void InvalidateStats();
+
 // First
 struct First { bool done; First() : done(false) {} operator bool() { if (done) return false; return (done = true); } };
 
 
 //////////
-// Main //
+// Jobs //
 //////////
 
-int main(int argc, char* argv[])
+// Job Kind
+enum JobKind { JobCompile, JobLink };
+
+// Job
+struct Job
 {
-    // Get Args
-    for (int a = 1; a < argc; a++)
-    {
-        args.push_back(argv[a]);
-    }
+	String cmd;     // Local Command
+	String output;  // Output File
+	String source;  // Source File (For Estimates)
+	String ppCmd;   // Preprocess Command (Empty When Not Remote-Capable)
+	String ppFile;  // Preprocessed Source File
+	String ccCmd;   // Compiler and Flags for a Preprocessed Source (Remote)
+	String extra;   // Extra Flags Appended to the Command (Not Part of Its Identity)
+	String errFile; // File Receiving the Command's stderr, Shown When It Fails (Empty for the Terminal)
+	String dir;     // Working Directory (Workspace Projects, Else Empty)
+	VecI   after;   // Path Ids of Outputs of Jobs That Must Finish First (In Their Directories)
+	JobKind kind;   // Compile or Link
+	double cost;    // Estimated Duration (Seconds)
+	long memory;    // Estimated Peak Resident Set (KB)
+	bool record;    // Record in Job History
+	bool lto;       // Link-Time Optimizing Link (Weighted Heavily Without History)
+	bool background;  // Started Only When No Other Job Can Be
+	String cacheBase;  // Cache Key Base (Compiler Identity and Command, Empty When Not Cacheable)
+	VecS   inputs;     // Files Whose Contents Complete the Cache Key
+	String batchCmd;   // Batched Compile Command, Sources Appended (Empty When Not Batchable)
+	int    batchMax;   // Most Sources in a Batch
+	bool   cutoff;     // Runs Only Because Inputs are Rebuilt (Skipped When They All Come Out Unchanged)
+	double rank;       // Remaining Critical Path (Own Cost Plus the Longest Path Through Jobs Waiting on It)
+
+	Job() : kind(JobCompile), cost(0), memory(0), record(true), lto(false), background(false), batchMax(1), cutoff(false), rank(0) {}
+	Job(const String& c, const String& o, JobKind k) : cmd(c), output(o), kind(k), cost(0), memory(0), record(true), lto(false), background(false), batchMax(1), cutoff(false), rank(0) {}
+	Job(const String& c, const String& o, const String& s, JobKind k) : cmd(c), output(o), source(s), kind(k), cost(0), memory(0), record(true), lto(false), background(false), batchMax(1), cutoff(false), rank(0) {}
+};
+
+typedef std::vector<Job> VecJ;
+
+// Running Job
+struct Running
+{
+	int job;
+	struct Executor* exec;
+	int slot;
 
-    // Help
-    if (IsOn("h"))
-    {
-        std::cerr << std::endl;
-        std::cerr << "Usage: bake [clean]" << std::endl;
-        std::cerr << "------------" << std::endl;
-        std::cerr << "-h help"      << std::endl;
-        std::cerr << "-r=Recipe.cfg (Default is Recipe.cfg)" << std::endl;
-        std::cerr << "-j=SpawnSize  (Default is 1)" << std::endl;
-        std::cerr << std::endl;
-        exit(0);
-    }
+	double start;
 
-    // Default Recipe
-    String pRecipe = "Recipe.cfg";
+	VecI batch;   // Jobs Compiled Together (Batched Compiles, Else Empty)
+	int  report;  // Read End of the Child's Report of Outputs Rebuilt Byte-Identical
 
-    // Override Recipe
-    if (HasOpt("r"))
-    {
-        pRecipe = GetOpt("r");
-    }
+	Running() : job(-1), exec(0), slot(-1), start(0), report(-1) {}
+	Running(int j, struct Executor* e, int s, double t) : job(j), exec(e), slot(s), start(t), report(-1) {}
+};
 
-    // Spawn Size
-    int pSpawn = 1;
-    if (HasOpt("j"))
-    {
-        pSpawn = Max(atoi(GetOpt("j").c_str()), 1);
-    }
+// Path Id of a Job's Output (In Its Directory; Job Graph Key)
+int OutputId(const Job& job);
 
-    ////////////
-    // Recipe //
-    ////////////
+// Path Ids of Qualified Paths (Interned As They Are, Not Qualified Again)
+VecI QualifiedIds(const VecS& paths);
 
-    // Open Recipe
-    std::ifstream file(pRecipe.c_str());
-    if (!file)
-    {
-        std::cerr << "Can't open recipe: " << pRecipe << std::endl;
-        exit(1);
-    }
+// Paths of Path Ids
+VecS PathStrs(const VecI& ids);
 
-    // Store Lines
-    String line;
-    while (getline(file, line))
-    {
-        // Skip Blanks and Comments
-        if (line.empty() || line[0] == '#')
-        {
-            continue;
-        }
+// Job Graph (Unfinished Inputs of Each Job, and the Jobs Waiting on It; Inputs Not in the Set are Ready)
+void JobGraph(const VecJ& jobs, VecI& waiting, std::vector<VecI>& dependents);
 
-        // Tokens
-        VecS tokens = Split(line);
+// Spawn Set of Jobs (Returns Number of Failed Jobs, Whose Outputs are Added to failedOutputs)
+int Spawn(const VecJ& jobs, int nSpawn, SetS* failedOutputs = 0);
 
-        if (!tokens.empty())
-        {
-            // Defines
-            if (tokens[0] == "Define")
-            {
-                // Sufficient Tokens
-                if (tokens.size() >= 2)
-                {
-                    // Variable Name
-                    String name = tokens[1];
-
-                    // Variable Value
-                    VecS value;
-                    for (int t = 2; t < tokens.size(); t++)
-                    {
-                        // Store Variable
-                        variables[name].push_back(tokens[t]);
-                    }
-                }
-            }
-            // Normal Line
-            else
-            {
-                lines.push_back(tokens);
-            }
-        }
-    }
+// Output Before a Job Runs (Content Hash, Empty When Missing)
+struct Prior
+{
+	String hash;
+};
 
-    // Substitute Variables
-    VecVecS replaced;
+// Note Output Before a Job Runs
+Prior NotePrior(const String& output);
 
-    // For Each Line
-    for (int i = 0; i < lines.size(); i++)
-    {
-        // Replaced Tokens
-        VecS repTokens;
+// Output Rebuilt Byte-Identical
+bool SameAsPrior(const String& output, const Prior& prior);
 
-        VecS tokens = lines[i];
-        for (int t = 0; t < tokens.size(); t++)
-        {
-            // Check For Variable
-            String token = tokens[t];
-            if (!token.empty() && token[0] == '$')
-            {
-                // Variable Name
-                String name = token.substr(1, token.size() - 1);
-
-                // Replace Token With Value
-                MapSV::iterator find = variables.find(name);
-                if (find != variables.end())
-                {
-					for (VecS::const_iterator v = find->second.begin(); v != find->second.end(); ++v)
-					{
-						repTokens.push_back(*v);
-					}
-                }
-            }
-            else
-            {
-                // Store Token
-                repTokens.push_back(token);
-            }
-        }
+// Read a Job's Report (One Flag per Member, '1' When Its Output Came Out Byte-Identical) and Close It
+String ReadReport(int fd);
 
-        // Add Line
-        replaced.push_back(repTokens);
-    }
 
-    // Replace
-    lines = replaced;
+/////////////////
+// Job History //
+/////////////////
 
-    // Clean - Special Processing
-    if (args.size() >= 1 && args[0] == "clean")
-    {
-        // Remove Directories
-        String dirsForRemoval;
-        dirsForRemoval += " " + GetVal("ObjectBinDir");
+// Job Statistics (From wait4)
+struct JobStats
+{
+	String output;    // Output File
+	String cmdHash;   // Command Hash
+	double wall;      // Wall Time (Seconds)
+	double user;      // User CPU (Seconds)
+	double sys;       // System CPU (Seconds)
+	long   maxRss;    // Peak Resident Set (KB)
+	long   inBlock;   // Block Reads
+	long   outBlock;  // Block Writes
+	long   when;      // Finish Time
 
-        VecVecS appDescs = GetValsM("AppDir");
+	JobStats() : wall(0), user(0), sys(0), maxRss(0), inBlock(0), outBlock(0), when(0) {}
+};
 
-        // For Each Application Description
-        for (VecVecS::iterator a = appDescs.begin(); a != appDescs.end(); ++a)
-        {
-            // Application Description
-            VecS appDesc = *a;
-
-            // Validate Description
-            if (appDesc.size() != 3 || appDesc[1] != "=>")
-            {
-                std::cerr << "Bad format in Recipe for AppDir, must be of the form 'appDir => binDir' not " << Concat(appDesc) << std::endl;
-                exit(1);
-            }
-
-            // Application Bin Directories
-            String pAppBinDir = appDesc[2];
-            dirsForRemoval += " " + pAppBinDir;
-        }
+typedef std::vector<JobStats>        VecJS;
+typedef std::map<String, JobStats>   MapSJS;
 
+// History (By Output and Command Hash)
+MapSJS History;
 
-        // Unit-Test Descriptions
-        VecVecS unitDescs = GetValsM("UnitTestDir");
+// Statistics of This Run
+VecJS RunStats;
 
-        // For Each Unit-Test Description
-        for (VecVecS::iterator u = unitDescs.begin(); u != unitDescs.end(); ++u)
-        {
-            // Unit-Test Description
-            VecS unitDesc = *u;
-
-            // Validate Description
-            if (unitDesc.size() != 3 || unitDesc[1] != "=>")
-            {
-                std::cerr << "Bad format in Recipe for UnitTestDir, must be of the form 'unitDir => binDir' not " << Concat(unitDesc) << std::endl;
-                exit(1);
-            }
-
-            // Unit-Test Directories
-            String pUnitBinDir = unitDesc[2];
-            dirsForRemoval += " " + pUnitBinDir;
-        }
+// Hash (64-bit FNV-1a, As Hex)
+String Hash(const String& data);
 
-        String rmDirCmd = "rm -rf " + dirsForRemoval;
-        std::cout << Star() << "Executing: " << rmDirCmd << std::endl;
-        system(rmDirCmd.c_str());
+// Current Time (Seconds)
+double Now();
 
-        String rmScriptCmd = "rm -f " + GetVal("UnitTestScript");
-        std::cout << Star() << "Executing: " << rmScriptCmd << std::endl;
-        system(rmScriptCmd.c_str());
+// Load Job History
+void LoadHistory();
 
-        String rmLibArcCmd = "rm -f " + GetVal("ObjectLibArc");
-        std::cout << Star() << "Executing: " << rmLibArcCmd << std::endl;
-        system(rmLibArcCmd.c_str());
+// Save Job History
+void SaveHistory();
 
-        // Finished
-        exit(0);
-    }
+// Record Job Statistics (Of a Batch Member, Its share of the Batch)
+void RecordStats(const Job& job, double start, const rusage& usage, double share = 1);
 
-    /////////////////
-    // Recipe Name //
-    /////////////////
+// Record Command of an Output Not Built by This Run (Timings Kept Unless wall is Given)
+void RecordCommand(const String& output, const String& cmdHash, double wall);
 
-    Prefix = FgSky() + "* Bake: " + FgOff() + FgOrg() + GetVal("Name") + FgOff() + " ";
-    std::cout << Prefix << std::endl;
+// Find Job Statistics (Exact Command, Else Any Command for Output)
+const JobStats* FindStats(const String& output, const String& cmdHash);
 
-    //////////////
-    // Includes //
-    //////////////
+// Report Slowest and Largest Jobs
+void ReportJobs(const VecJS& stats, int n);
 
-    // Include Directories
-    inclDirs = GetVals("IncludeDirs");
+// Naive Job Order (Directory Order, No Estimates)
+bool NaiveOrder = false;
 
-    // Include Flags
-    String includeFlags;
-    for (VecS::iterator i = inclDirs.begin(); i != inclDirs.end(); ++i)
-    {
-        includeFlags += " -I" + *i;
-    }
+// Estimate Job Costs and Order by Remaining Critical Path (Reports Gain Over Naive Order)
+VecJ OrderJobs(const VecJ& jobs, int nSpawn);
 
-    // Library Directories
-    VecS libDirs = GetVals("LibraryDirs");
+// Estimated Makespan of Jobs on nSpawn Slots (Each Started When Its Inputs are Done, Earliest in Order First)
+double Makespan(const VecJ& jobs, int nSpawn);
 
-    // Libraries
-    VecS libraries = GetVals("Libraries");
+// Cost and Memory Multiplier of LTO Links Without History
+const int LtoWeight = 8;
 
-    // Library Filenames (For Dependencies)
-    SetS libFileNames = GetLibFiles();
+// File Size
+long GetFileSize(const String& path);
 
-    // Library Flags
-    String libraryFlags;
+// Hash of File Content
+String HashFile(const String& path);
 
-    // Add Library Paths
-    for (VecS::iterator l = libDirs.begin(); l != libDirs.end(); ++l)
-    {
-        libraryFlags += " -L" + *l;
-    }
 
-    // Add Libraries
-    for (VecS::iterator l = libraries.begin(); l != libraries.end(); ++l)
-    {
-        libraryFlags += " -l" + *l;
-    }
+///////////////////////
+// Unit-Test Results //
+///////////////////////
 
-    // Compiler
-    String pCompiler = GetVal("Compiler");
-    String pCompPreFlags  = Concat(GetVals("CompPreFlags"));
-    String pCompPostFlags = Concat(GetVals("CompPostFlags"));
+// Input Hashes of Passing Runs (By Unit-Test Binary, Most Recent Last)
+MapSV TestResults;
 
+// Most Input Hashes Kept per Unit-Test
+const int TestResultsKept = 16;
 
-    ///////////////////
-    // Build Objects //
-    ///////////////////
+// Load Unit-Test Results
+void LoadTestResults();
 
-    String pObjSrcDir = GetVal("ObjectSrcDir");
-    String pObjBinDir = GetVal("ObjectBinDir");
-    String pObjLibArc = GetVal("ObjectLibArc");
-    MkDir(pObjBinDir);
+// Save Unit-Test Results
+void SaveTestResults();
 
-    // Build Objects
-    {
-        First display;
+// Digest of Inputs Shared by a Project's Unit-Tests (Names and Content Hashes, Computed Once per Project)
+String SharedInputsDigest(const SetS& sharedInputs);
 
-        // Objects
-        SetS objects;
+// Unit-Test Input Hash (Binary, Include Closure, and the Shared Inputs Digest)
+String TestInputHash(const String& binFile, const VecI& includes, const String& sharedDigest);
 
-        // Build Commands
-        VecS cmds;
+// Unit-Test Passed With Inputs
+bool TestPassed(const String& binFile, const String& inputHash);
 
-        // Object Source Files
-        VecS objSrcFiles = ListFiles(pObjSrcDir);
+// Record Passing Unit-Test
+void RecordTestPass(const String& binFile, const String& inputHash);
 
-        // For Each Object Source File
-        for (VecS::iterator o = objSrcFiles.begin(); o != objSrcFiles.end(); ++o)
-        {
-            // Object Source File
-            const String& objSrcName = *o;
-
-            // Confirm ".cpp"
-            if (EndsWith(objSrcName, ".cpp"))
-            {
-                String objSrcFile = Join(pObjSrcDir, objSrcName);
-
-                // Source Exists
-                if (FileExists(objSrcFile))
-                {
-                    // Object File
-                    String objBinFile = Join(pObjBinDir, ChopEnd(objSrcName, 4) + ".o");
-
-                    // Add To Objects
-                    objects.insert(objBinFile);
-
-                    // Need-To-Build
-                    bool needToBuild = false;
-
-                    // Object Doesn't Exist
-                    if (!FileExists(objBinFile))
-                    {
-                        needToBuild = true;
-                    }
-                    // Object Exists
-                    else
-                    {
-                        // Object Modification Time
-                        int objModTime = GetFileModTm(objBinFile);
-
-                        // Source File Modified
-                        if (GetFileModTm(objSrcFile) > objModTime)
-                        {
-                            needToBuild = true;
-                        }
-                        // Check Includes
-                        else
-                        {
-                            // Includes
-                            SetS includes = GetAllIncls(objSrcFile);
-
-                            if (GetFileModTm(includes) > objModTime)
-                            {
-                                needToBuild = true;
-                            }
-                        }
-                    }
-
-                    // Need To Build
-                    if (needToBuild)
-                    {
-                        String cmd = pCompiler;
-                        cmd += " "    + pCompPreFlags;
-                        cmd += " -c " + objSrcFile;
-                        cmd += " -o " + objBinFile;
-                        cmd += " "    + includeFlags;
-                        cmd += " "    + pCompPostFlags;
-
-                        cmds.push_back(cmd);
-
-                        // Display
-                        if (display) Display("Building", "Objects", pObjSrcDir);
-                    }
-                }
-			}
-		}
-
-		// Spawn Object Builds
-		Spawn(cmds, pSpawn);
-
-		// Build Object Archive (Static Library)
-		if (!FileExists(pObjLibArc) || GetFileModTm(objects) > GetFileModTm(pObjLibArc))
-		{
-			// Display
-			if (display) Display("Building", "Objects", pObjSrcDir);
-			
-			// Create Directory
-			String objLibDir = GetDir(pObjLibArc);
-			MkDir(objLibDir);
-
-			// Archive Command
-			String objLibCmd = "ar rcs " + pObjLibArc + " " + Concat(objects);
-			std::cout << Prefix << FgGrn() << "Executing: " << FgOff() << objLibCmd << std::endl;
-		
-			// System Call
-			int rc = system(objLibCmd.c_str());
-			if (rc != 0)
-			{
-				std::cerr << "Failed to build object archive: " << pObjLibArc << std::endl;
-				{
-					std::cerr << "Failed to build object archive: " << pObjLibArc << std::endl;
-					exit(1);
-				}
-			}
-		}
-	}
 
-	////////////////
-	// Build Apps //
-	////////////////
+/////////////////////////
+// Header Fingerprints //
+/////////////////////////
 
-	{
-		// Build Commands
-		VecS cmds;
+// Fingerprint Headers by Token Stream (Comment and Whitespace Edits Don't Rebuild Dependents)
+bool FingerprintMode = false;
 
-		// Application Descriptions
-		VecVecS appDescs = GetValsM("AppDir");
+// Recorded Fingerprints (By Path: Time the Token Stream Last Changed, Hash of It)
+std::map<String, std::pair<int, String> > HeaderPrints;
 
-		// For Each Application Description
-		for (VecVecS::iterator a = appDescs.begin(); a != appDescs.end(); ++a)
-		{
-			First display;
+// Load Header Fingerprints
+void LoadHeaderPrints();
 
-			// Application Description
-			VecS appDesc = *a;
+// Save Header Fingerprints
+void SaveHeaderPrints();
 
-			// Validate Description
-			if (appDesc.size() != 3 || appDesc[1] != "=>")
-			{
-				std::cerr << "Bad format in Recipe for AppDir, must be of the form 'appDir => binDir' not " << Concat(appDesc) << std::endl;
-				exit(1);
-			}
+// Token Stream of Source Text (Comments Dropped, Whitespace Collapsed, Literals Kept)
+String TokenStream(const String& text);
 
-			// Application Directories
-			String pAppSrcDir = appDesc[0];
-			String pAppBinDir = appDesc[2];
-			MkDir(pAppBinDir);
+// Record Fingerprint of a Scanned File (Sets the Time Its Token Stream Last Changed)
+void RecordPrint(int file, const String& text);
 
-			// Application Source Files
-			VecS appSrcFiles = ListFiles(pAppSrcDir);
+// Include Modification Time (Time the Token Stream Last Changed, in Fingerprint Mode)
+int InclModTm(int file);
 
-			// For Each Application Source File
-			for (VecS::iterator a = appSrcFiles.begin(); a != appSrcFiles.end(); ++a)
-			{
-				// Only C++ Files
-				if (!EndsWith(*a, ".cpp"))
-				{
-					continue;
-				}
 
-				// Application Source File
-				String appSrcFile = Join(pAppSrcDir, *a);
+/////////////////
+// Run History //
+/////////////////
 
-				// Application Binary File
-				String appBinFile = Join(pAppBinDir, ChopEnd(*a, 4));
+// Run Record (Named Values, and Durations of the Jobs That Ran)
+struct RunRecord
+{
+	MapSD values;  // when, wall, plan, build, test, checked, rebuilt, failed, cache hits
+	MapSD jobs;    // Job Wall Times (By Output)
+};
 
-				// Includes
-				SetS includes = GetAllIncls(appSrcFile);
+typedef std::vector<RunRecord> VecR;
 
-				// Check Need-to-Build
-				bool needToBuild = false;
+// Counters of This Run
+long StatHits       = 0;  // Stats Answered From the Cache
+long StatMisses     = 0;  // Stats Made
+long InclHits       = 0;  // Include Lists Answered From the Cache
+long InclScans      = 0;  // Files Scanned for Includes
+long OutputsChecked = 0;  // Outputs Checked (Up to Date or Rebuilt)
+long TestsRun       = 0;  // Unit-Tests Run
+long TestsSkipped   = 0;  // Unit-Tests Skipped (Passed With the Same Inputs)
+long CacheHits      = 0;  // Outputs Fetched From the Remote Cache Before Scheduling
+long JobsCutOff     = 0;  // Jobs Skipped as Their Rebuilt Inputs Came Out Unchanged
 
-				// No Binary
-				if (!FileExists(appBinFile))
-				{
-					needToBuild = true;
-				}
-				// Include-File Modified
-				else if (GetFileModTm(includes) > GetFileModTm(appBinFile))
-				{
-					needToBuild = true;
-				}
-				// Source-File Modified
-				else if (GetFileModTm(appSrcFile) > GetFileModTm(appBinFile))
-				{
-					needToBuild = true;
-				}
-				// Object-File Library Modified
-				else if (GetFileModTm(pObjLibArc) > GetFileModTm(appBinFile))
-				{
-					needToBuild = true;
-				}
-				// Library-File Modified
-				else if (GetFileModTm(libFileNames) > GetFileModTm(appBinFile))
-				{
-					needToBuild = true;
-				}
+// Most Run Records Kept
+const int RunHistoryKept = 500;
 
-				// Need To Build
-				if (needToBuild)
-				{
-					String cmd = pCompiler;
-					cmd += " "    + pCompPreFlags;
-					cmd += " "    + appSrcFile;
-					cmd += " -o " + appBinFile;
-					cmd += " "    + includeFlags;
-					cmd += " "    + libraryFlags;
-					cmd += " "    + pCompPostFlags;
-					cmds.push_back(cmd);
-
-					// Display
-					if (display) Display("Building", "Apps", pAppSrcDir);
-				}
-			}
-		}
+// Load Run Records (Oldest First)
+VecR LoadRuns();
 
-		// Spawn Application Builds
-		Spawn(cmds, pSpawn);
-	}
+// Append Run Record (Values and Job Durations of This Run)
+void RecordRun(const MapSD& values);
 
+// Report Trends of the Last n Runs, and Regressions of the Latest Run Beyond threshold (Fraction) Against the Median of Earlier Runs
+void ReportRuns(int n, double threshold, bool json);
 
-	//////////////////////////
-	// Build Unit-Test Apps //
-	//////////////////////////
 
-	{
-		// Build Commands
-		VecS cmds;
+///////////////////
+// Build Journal //
+///////////////////
 
-		// Unit-Test-Run Script
-		String unitScript = GetVal("UnitTestScript");
-		std::ofstream unitStream(unitScript.c_str());
+// Journal of Started and Finished Jobs (Open While Spawning, Else -1)
+int JournalFd = -1;
 
-		if (!unitStream)
-		{
-			std::cerr << "Unable to create unit-test script: " << unitScript << std::endl;
-			exit(1);
-		}
+// Resume Interrupted Build (Outputs of Jobs Started but Not Finished are Removed, So They Rebuild; Finished Commands are Recorded)
+void ResumeJournal();
 
-		// Unit-Test Descriptions
-		VecVecS unitDescs = GetValsM("UnitTestDir");
+// Open Journal
+void OpenJournal();
 
-		// For Each Unit-Test Description
-		for (VecVecS::iterator u = unitDescs.begin(); u != unitDescs.end(); ++u)
-		{
-			First display;
+// Append Journal Entry (start, done or fail, the Qualified Output and Any Detail)
+void Journal(const String& entry, const String& output, const String& detail = "");
 
-			// Unit-Test Description
-			VecS unitDesc = *u;
+// Close and Remove Journal (Every Job Finished)
+void CloseJournal();
 
-			// Validate Description
-			if (unitDesc.size() != 3 || unitDesc[1] != "=>")
-			{
-				std::cerr << "Bad format in Recipe for UnitTestDir, must be of the form 'unitDir => binDir' not " << Concat(unitDesc) << std::endl;
-				exit(1);
-			}
+// Temporary Beside an Output (Objects' Replaces the Extension, So Files Compilers Name After It, .dwo and Clang Traces, Come Out as for the Object)
+String TempFile(const String& output);
 
-			// Unit-Test Directories
-			String pUnitSrcDir = unitDesc[0];
-			String pUnitBinDir = unitDesc[2];
-			MkDir(pUnitBinDir);
+// Command Writing a Temporary Beside the Output (Named in temp; Command Unchanged, temp Empty, When It Names No Output)
+String AtomicCmd(const Job& job, String& temp);
 
-			// Unit-Test Source Files
-			VecS unitSrcFiles = ListFiles(pUnitSrcDir);
+// Run Job Command, Renaming Its Temporary Output Into Place on Success (Returns Exit Code)
+int RunAtomic(const Job& job);
 
-			// For Each Unit-Test Source File
-			for (VecS::iterator a = unitSrcFiles.begin(); a != unitSrcFiles.end(); ++a)
-			{
-				// Only C++ Files
-				if (!EndsWith(*a, ".cpp"))
-				{
-					continue;
-				}
 
-				// Unit-Test Source File
-				String unitSrcFile = Join(pUnitSrcDir, *a);
+/////////////
+// Targets //
+/////////////
 
-				// Unit-Test Binary File
-				String unitBinFile = Join(pUnitBinDir, ChopEnd(*a, 4));
+// Requested Targets (Positional Arguments: App or Unit-Test Names, Outputs, Sources or Headers; None Builds Everything)
+VecS Targets;
 
-				// Add to Unit-Test-Run Script
-				unitStream << "./" << unitBinFile << std::endl;
+// Target Paths (Normalized, Absolute in a Workspace)
+VecS TargetPaths;
 
-				// Includes
-				SetS includes = GetAllIncls(unitSrcFile);
+// Targets Matched by an Output
+SetS TargetsMatched;
 
-				// Check Need-to-Build
-				bool needToBuild = false;
+// A Target May Be Included (Selecting Then Needs Include Closures)
+bool IncludeTargets = false;
 
-				// No Binary
-				if (!FileExists(unitBinFile))
-				{
-					needToBuild = true;
-				}
-				// Include Modified
-				else if (GetFileModTm(includes) > GetFileModTm(unitBinFile))
-				{
-					needToBuild = true;
-				}
-				// Source Modified
-				else if (GetFileModTm(unitSrcFile) > GetFileModTm(unitBinFile))
-				{
-					needToBuild = true;
-				}
-				// Object Library Modified
-				else if (GetFileModTm(pObjLibArc) > GetFileModTm(unitBinFile))
-				{
-					needToBuild = true;
-				}
-				// Library-File Modified
-				else if (GetFileModTm(libFileNames) > GetFileModTm(unitBinFile))
-				{
-					needToBuild = true;
-				}
+// Outputs Selected by Targets, and Those Depending on Them (Path Ids)
+SetI Selected;
 
-				// Need To Build
-				if (needToBuild)
-				{
-					String cmd = pCompiler;
-					cmd += " "    + pCompPreFlags;
-					cmd += " "    + unitSrcFile;
-					cmd += " -o " + unitBinFile;
-					cmd += " "    + includeFlags;
-					cmd += " "    + libraryFlags;
-					cmd += " "    + pCompPostFlags;
-					cmds.push_back(cmd);
-
-					// Display
-					if (display) Display("Building", "Unit-Tests", pUnitSrcDir);
-				}
-			}
-		}
+// Add Target (Path Resolved From the Working Directory in a Workspace)
+void AddTarget(const String& target, bool workspace);
 
-		// Close Unit-Test-Run Script
-		unitStream.close();
+// Target Names the Output, Its Name, Its Source or One of Its Includes
+bool Targeted(const String& name, const String& output, const String& source, const VecI& includes);
 
-		// Spawn Unit-Test Builds
-		Spawn(cmds, pSpawn);
+// Keep Only Jobs of Selected Outputs and the Jobs They Wait For (Every Target Must Match)
+void SelectJobs(VecJ& jobs);
 
-		// Run Unit-Tests
-		System("chmod u+x " + unitScript);
-		System("./" + unitScript);
-	}
+// Report Outputs Depending on the Targets
+void ReportAffected();
 
 
-	return 0;
-}
+/////////////
+// Explain //
+/////////////
 
+// Explain Why Each Job Runs
+bool ExplainMode = false;
 
+// Why Each Job Runs (By Qualified Output)
+MapSS Reasons;
 
+// Explain Job (Printed in Explain Mode)
+void Explain(const String& output, const String& reason);
 
+// Reason for Input Newer Than Output (With Both Timestamps)
+String NewerReason(const String& input, const String& output);
 
+// Most Recently Modified File
+String NewestFile(const SetS& files);
 
-///////////////////////////
-// Helper Implementation //
-///////////////////////////
+// Most Recently Modified File (Path Ids)
+String NewestFile(const VecI& files);
 
-// Max
-int Max(int a, int b)
-{
-	return (a > b) ? a : b;
-}
+// Command Differs From the Last Successful Run
+bool CommandChanged(const String& output, const String& cmd);
 
-// Join Paths
-String Join(const String& a, const String& b)
-{
-	return a + "/" + b;
-}
+// Format Timestamp
+String FormatTime(int t);
 
-// Get Directory
-String GetDir(const String& path)
+// Header Impact (Dependents of a Header, By Path Id)
+struct Impact
 {
-	int final = -1;
-	int i = 0;
-	while (i < path.size())
-	{
-		if (path[i] == '/')
-		{
-			final = i;
-		}
+	SetS   tus;   // Translation Units Including It
+	SetS   bins;  // Binaries Rebuilt Because of It
+	double cost;  // Historical Cost of Rebuilding Them (Seconds)
+	bool   lib;   // Included by an Object Library Source
 
-		i++;
-	}
+	Impact() : cost(0), lib(false) {}
+};
 
-	if (final == -1)
-	{
-		return "./";
-	}
+// Report Headers by Rebuild Fan-Out, Weighted by Historical Cost
+void ReportImpact(const String& objSrcDir, const String& objBinDir, bool relinkAll, int n);
 
-	return path.substr(0, final);
-}
 
-// Join Paths
-String Join(const String& a, const String& b, const String& c)
-{
+///////////////////////////
+// Compile Cost Analysis //
+///////////////////////////
+
+// Analysis Mode (Empty When Off, "size" or "trace")
+String AnalyzeMode;
+
+// Compiler is Clang
+bool IsClang(const String& compiler);
+
+// Capture Command Output
+String Capture(const String& cmd);
+
+// Timing Flags for an Object Compile (Clang -ftime-trace, GCC -ftime-report to stderr, Captured in the Timing File)
+String TraceFlags(bool clang);
+
+// Timing File of an Object Compile
+String TraceFile(bool clang, const String& objBinFile);
+
+// Aggregate Clang -ftime-trace Events (Headers, Templates, Functions; Microseconds)
+void ParseTimeTrace(const String& json, std::map<String, MapSD>& totals);
+
+// Aggregate GCC -ftime-report Phases (Microseconds)
+void ParseTimeReport(const String& text, std::map<String, MapSD>& totals);
+
+// Quote String for JSON
+String JsonStr(const String& str);
+
+// Report Compile Costs (Text, and JSON in StateDir)
+void ReportCompileCost(const VecJ& ppJobs, const VecS& traceFiles, int nSpawn, int n);
+
+
+///////////////
+// Admission //
+///////////////
+
+// Memory Budget for Local Jobs (KB, 0 When Unlimited)
+long MemBudget = 0;
+
+// Concurrent Link and Compile Caps (0 When Limited Only by -j)
+int LinkSpawn    = 0;
+int CompileSpawn = 0;
+
+// Admission Control (Memory Budget and Per-Kind Caps)
+struct Admission
+{
+	long used;
+	int  links;
+	int  compiles;
+
+	Admission() : used(0), links(0), compiles(0) {}
+
+	// count More Jobs of a Kind Fit, Needing memory Together (A Single Job Always Fits When Nothing Local Runs)
+	bool Admits(JobKind kind, int count, long memory, bool local) const;
+
+	// Job Fits
+	bool Admits(const Job& job, bool local) const { return Admits(job.kind, 1, job.memory, local); }
+
+	// Account Started Jobs (One Job, or the Members of a Batch)
+	void Admit(const VecJ& jobs, const VecI& members, bool local);
+
+	// Account Finished Jobs
+	void Retire(const VecJ& jobs, const VecI& members, bool local);
+};
+
+// Default Memory Budget (Available Memory, Limited by cgroup memory.max)
+long GetMemoryBudget();
+
+// cgroup v2 Directory of This Process Having a Control File (The Root When None Does)
+String GetCgroupDir(const String& control);
+
+
+///////////////
+// Placement //
+///////////////
+
+// Usable CPUs by NUMA Node (Affinity Mask Grouped by Node, One Node Without NUMA)
+std::vector<VecI> CpuNodes;
+
+// Worker Placement (off, node or core)
+String PinMode = "off";
+
+// Discover CPU Topology (Usable CPUs by NUMA Node)
+void LoadTopology();
+
+// CPU Limit (Usable CPUs, Limited by cgroup cpu.max Quota)
+int GetCpuLimit();
+
+// Place Worker of a Local Slot (Slots Interleaved Across Nodes, Pinned to Its Node or One Core)
+void PlaceWorker(int slot);
+
+// Lower Priority of the Build (nice Level, and a Best-Effort I/O Priority to Match)
+void LowerPriority(int nice);
+
+// nice Level of Job Processes When Embedded (The Host Keeps Its Priority; 0 for None)
+int JobNice = 0;
+
+
+///////////////
+// Executors //
+///////////////
+
+// Executor (Slots are Acquired and Released in the Parent, Jobs Run in a Forked Child)
+struct Executor
+{
+	virtual ~Executor() {}
+
+	// Name (For Display)
+	virtual String Name() = 0;
+
+	// Can Run Job
+	virtual bool Accepts(const Job& job) = 0;
+
+	// Acquire Slot (-1 When Busy)
+	virtual int Acquire() = 0;
+
+	// Release Slot
+	virtual void Release(int slot) = 0;
+
+	// Run Job (Returns Exit Code)
+	virtual int Run(const Job& job, int slot) = 0;
+
+	// Runs on This Machine (Counts Against Memory Budget)
+	virtual bool IsLocal() = 0;
+};
+
+// Local Executor (Runs Anything, Up To -j at Once)
+struct LocalExecutor : Executor
+{
+	int nSpawn;
+	int busy;
+	std::vector<bool> used;  // Slots in Use (Stable Per Job, For Placement)
+
+	LocalExecutor(int n) : nSpawn(n), busy(0), used(n, false) {}
+
+	String Name();
+	bool Accepts(const Job& job);
+	int  Acquire();
+	void Release(int slot);
+	int  Run(const Job& job, int slot);
+	bool IsLocal() { return true; }
+};
+
+// Remote Worker
+struct Worker
+{
+	String host;
+	String port;
+	int    slots;
+	int    busy;
+
+	Worker() : slots(1), busy(0) {}
+};
+
+// Remote Executor (Ships Preprocessed Compiles to bake-worker Daemons)
+struct RemoteExecutor : Executor
+{
+	std::vector<Worker> workers;
+
+	RemoteExecutor(const String& spec);
+
+	String Name();
+	bool Accepts(const Job& job);
+	int  Acquire();
+	void Release(int slot);
+	int  Run(const Job& job, int slot);
+	bool IsLocal() { return false; }
+};
+
+// Remote Executor (Null When Building Locally)
+RemoteExecutor* Remote = 0;
+
+// Default Worker Port
+const char* const WorkerPort = "7070";
+
+// Compilers a Worker Runs (Names or Paths a Request's Command Must Start With Exactly)
+VecS WorkerCompilers;
+
+// Default Worker Compilers
+const char* const WorkerDefaultCompilers = "g++,gcc,c++,cc,clang++,clang";
+
+// Worker Sandbox Root (Include Directories a Request May Name Lie Under It; None When Empty)
+String WorkerRoot;
+
+// Job Server Pipe (GNU Make Protocol, -1 When Not Started)
+int JobServerFds[2] = { -1, -1 };
+
+// Job Server Read End of Our Own (Non-Blocking, Children Keep Blocking Reads)
+int JobServerRead = -1;
+
+// Start Job Server (Tokens Beyond Each Process's Implicit One, Advertised in MAKEFLAGS)
+void StartJobServer(int nSpawn);
+
+// Run Worker Daemon
+void RunWorker(const String& bindAddr, const String& port, int nSlots);
+
+// Check a Request's Compile Command (Configured Compiler, Then Allowed Flags Only; Why When Rejected)
+bool WorkerAccepts(const VecS& argv, String& why);
+
+// Check Compile Flags Against the Worker Allow-List (Flags Naming No Path, Include Directories Under the Worker Root; Why When Rejected)
+bool WorkerFlags(const VecS& args, String& why);
+
+// Command Compiling a Preprocessed Source on a Worker (Preprocessor Flags Dropped; Empty When a Worker Would Refuse a Flag)
+String RemoteCompileCmd(const String& compiler, const String& flags);
+
+// Loopback Address (Reachable Only From This Host)
+bool IsLoopback(const String& bindAddr);
+
+// Connect to Host (Timeout in Seconds for Connecting, Sending and Receiving, 0 for None)
+int Connect(const String& host, const String& port, int timeout = 0);
+
+// Listen on Address (Exits When Unable)
+int Listen(const String& bindAddr, const String& port);
+
+// Serve Connections, Each in a Forked Child, Up To nSlots at Once
+void ServeLoop(int fd, int nSlots, void (*serve)(int));
+
+// Send All Data
+bool SendAll(int fd, const String& data);
+
+// Receive Line
+bool RecvLine(int fd, String& line);
+
+// Receive Exact Number of Bytes
+bool RecvAll(int fd, String& data, size_t n);
+
+// Parse Message Length (Decimal Digits Only, Surrounding Blanks Allowed; False When Malformed or Above max)
+bool ParseLength(const String& text, size_t max, size_t& length);
+
+// Largest Message Accepted Between Bake, Workers and the Cache (Bytes)
+const size_t MaxMessage = (size_t)1 << 30;
+
+// Execute Without Shell (Output to Log File, Returns Exit Code)
+int Exec(const VecS& argv, const String& logFile);
+
+
+//////////////////
+// Remote Cache //
+//////////////////
+
+// Remote Cache (Content-Addressed Outputs, Fetched and Stored With HTTP GET and PUT)
+struct RemoteCache
+{
+	String host;
+	String port;
+	String path;   // Key Prefix (URL Path, Empty for the Root)
+	bool   read;   // Fetch Outputs
+	bool   write;  // Store Outputs Built Here
+
+	RemoteCache(const String& spec, const String& policy);
+
+	// Fetch Output Into File (1 Hit, 0 Miss, -1 Unreachable)
+	int Get(const String& key, const String& file, mode_t mode);
+
+	// Store Output File
+	bool Put(const String& key, const String& file);
+};
+
+// Remote Cache (Null Without -cache)
+RemoteCache* Cache = 0;
+
+// Default Cache Port
+const char* const CachePort = "7071";
+
+// Cache Request Timeout (Seconds)
+const int CacheTimeout = 5;
+
+// Cache Server Store Directory
+String CacheStore = "/tmp/bake-cache";
+
+// Cache Server Largest Stored Output (Bytes, Larger Stores are Refused)
+size_t CacheMaxSize = (size_t)256 << 20;
+
+// Compiler Identity (Hash of Its Version Output, Once per Compiler)
+String CompilerId(const String& compiler);
+
+// Make Job Cacheable When a Cache is Used (Keyed by Compiler Identity, Command, and Contents of Inputs and Includes)
+void CacheJob(Job& job, const String& compiler, const VecS& inputs, const VecI& includes);
+
+// Cache Key of a Job
+String CacheKey(const Job& job);
+
+// Run Job Through the Cache (Fetched on a Hit, Stored After Building on a Miss)
+int CacheRun(Executor* exec, const Job& job, int slot);
+
+// Probe the Cache, Then Fetch Outputs of Ready Jobs in Parallel Before Scheduling (Fetched Jobs are Dropped)
+void Prefetch(VecJ& jobs, int nFetch);
+
+// HTTP Exchange With the Cache (Returns Status, -1 When Unreachable; Body of a Successful GET in response)
+int CacheHttp(const RemoteCache& cache, const String& method, const String& key, const String& body, String& response);
+
+// Serve One Cache Request
+void ServeCache(int fd);
+
+// Run Cache Server
+void RunCacheServer(const String& bindAddr, const String& port, int nSlots);
+
+
+//////////////
+// Projects //
+//////////////
+
+// Project (One Recipe and the State of Its Build)
+struct Project
+{
+	String  name;       // Name (Workspace Projects)
+	String  dir;        // Directory (Absolute for Workspace Projects, Else Empty)
+	String  recipe;     // Recipe File
+	VecI    deps;       // Projects Linked Against (Indices, Loaded Earlier)
+
+	VecVecS lines;      // Recipe Lines (Variables Substituted)
+	MapSV   variables;  // Recipe Variables
+	VecS    inclDirs;   // Include Directories
+	String  prefix;     // Display Prefix
+
+	// Settings
+	String includeFlags;
+	String libraryFlags;
+	SetS   libFileNames;
+	String compiler;
+	String compPreFlags;
+	String compPostFlags;
+
+	// Link-Time Optimization (Compile and Link Flags) and Archiver
+	String ltoCompFlags;
+	String ltoLinkFlags;
+	String archiver;
+
+	// Split Debug Info (Compile Flags, and the Packager of Binaries' .dwo Files When Packaging)
+	String dwarfFlags;
+	String dwp;
+
+	// Compile Batching (Most Objects per Compiler Invocation, Include and Recipe Flags With Absolute Paths)
+	int    batch;
+	String batchInclFlags;
+	String batchPreFlags;
+	String batchPostFlags;
+
+	// Object Library
+	bool   objLibShared;
+	String objSrcDir;
+	String objBinDir;
+	String objLibArc;
+	String objLibSo;
+	String objLib;
+	String objLibStamp;
+
+	// Unit-Tests Linked Into One Runner per Directory
+	bool unitRunner;
+
+	// Object Library Selected by a Target (Binaries Linking It Are Too)
+	bool libSelected;
+
+	// C++20 Modules (Mapper of Module Names to BMIs of This Flag Set, Interface Objects by Module, Interfaces Being Rebuilt)
+	bool   modules;
+	String bmiDir;
+	String moduleFlags;
+	MapSS  moduleObjs;
+	SetS   rebuiltModules;
+
+	// Unit-Test Inputs (Binaries, or Objects When Linked Into a Runner), Their Include Closures and Run Commands
+	VecS              unitFiles;
+	std::vector<VecI> unitIncludes;
+	VecS              unitCmds;
+
+	// Object Library (Own or a Dependency's) Failed
+	bool failed;
+
+	Project() : batch(1), objLibShared(false), unitRunner(false), libSelected(false), modules(false), failed(false) {}
+};
+
+typedef std::vector<Project> VecP;
+
+// Current Project Directory (Empty Outside a Workspace)
+String ProjectDir;
+
+// Path in Directory (Unchanged When Absolute or the Directory is Empty)
+String InDir(const String& dir, const String& path);
+
+// Path in Current Project Directory
+String Qualify(const String& path);
+
+// Normalize Path (Collapse "." and "..")
+String NormalizePath(const String& path);
+
+// Load Recipe (Lines With Variables Substituted)
+void LoadRecipe(const String& recipe, VecVecS& recipeLines, MapSV& recipeVars);
+
+// Load Project (Recipe, Name and Include Directories)
+void LoadProject(Project& project);
+
+// Load Workspace (Projects in Dependency Order, State Shared)
+void LoadWorkspace(const String& workspace, VecP& projects);
+
+// Make Project Current (Recipe, Directory, Include Resolution)
+void UseProject(Project& project);
+
+// Include Context (Direct Includes and Resolved Names Depend on the Include Directories)
+struct InclContext
+{
+	std::vector<VecI>     incls;
+	std::vector<char>     scanned;
+	std::map<String, int> resolved;
+};
+
+// Include Contexts (By Include Directories) and the Current One
+std::map<String, InclContext> InclContexts;
+String InclContextKey;
+
+// Use Include Resolution of a Set of Include Directories (Shared Between Projects)
+void UseInclContext(const String& key);
+
+// Commands Removing Project Outputs
+VecS CleanCommands();
+
+// Remove Project Outputs
+void CleanProject();
+
+// Resolve Project Settings (LTO Parallelism From nSpawn)
+void ConfigureProject(Project& project, int nSpawn);
+
+// Collect Object and Object Library Jobs
+void CollectObjects(Project& project, VecJ& jobs, VecJ& ppJobs, VecS& traceFiles);
+
+// Collect App and Unit-Test Jobs (Waiting for the Libraries They Link)
+void CollectBinaries(Project& project, const VecP& projects, VecJ& jobs, VecJ& ppJobs);
+
+// Collect Compile and Link Jobs of an App or Unit-Test (Links Wait for Their Object and Libraries)
+void CollectBinary(Project& project, const String& srcFile, const String& objFile, const String& binFile, const VecI& includes, const VecS& libs, const String& rebuiltLib, VecJ& jobs, VecJ& ppJobs, First& display, const String& label, const String& srcDir);
+
+// Collect Compile Job of an App, Unit-Test or Runner Object (Returns Why It Runs, Empty When Up to Date)
+String CollectCompile(Project& project, const String& srcFile, const String& objFile, const VecI& includes, const String& flags, VecJ& jobs, VecJ& ppJobs);
+
+// Collect Link Job of a Binary (Waits for Its Objects and Libraries; rebuiltObj Names an Object Being Rebuilt)
+void CollectLink(Project& project, const String& srcFile, const VecS& objFiles, const String& rebuiltObj, const String& binFile, const VecS& libs, const String& rebuiltLib, VecJ& jobs, First& display, const String& label, const String& srcDir);
+
+// Split Debug Info File of an Object (Beside It, as the Compiler Writes It)
+String DwoFile(const String& objFile);
+
+// Unit-Test Entry Point in a Runner (Symbol of the Unit-Test's main; _0 Suffixed Without Arguments, _2 With argc and argv)
+String RunnerEntry(const String& name);
+
+// main Takes argc and argv (Its First Definition in the Source)
+bool MainTakesArgs(const String& source);
+
+// Unit-Test Entry Header (Forced Include Declaring main With the Entry Point as Its Symbol, So It Stays main to the Compiler)
+String RunnerEntryHeader(const String& name, bool takesArgs);
+
+// Unit-Test Runner Source (Dispatch Table of Entry Points; Runs One Test, or Forks Each)
+String RunnerSource(const VecS& names);
+
+// Run Unit-Tests Whose Inputs Changed
+void RunUnitTests(Project& project);
+
+
+/////////////
+// Modules //
+/////////////
+
+// Module Unit (Module Declared and Modules Imported; Interfaces and Partitions Produce a BMI)
+struct ModuleUnit
+{
+	String name;
+	bool   interface;
+	VecS   imports;
+
+	ModuleUnit() : interface(false) {}
+};
+
+// Module Units of Files (By Path Id)
+std::map<int, ModuleUnit> ModuleUnits;
+
+// Scan Module Unit (module, export module and import Declarations; Header Units Ignored)
+const ModuleUnit& GetModuleUnit(int file);
+
+// BMI of a Module
+String ModuleBmi(const Project& project, const String& module);
+
+// Visit Module Source (Interfaces It Imports First; state 1 Visiting, 2 Ordered)
+void VisitModuleSource(const String& name, const MapSS& srcByModule, std::map<String, int>& state, const String& objSrcDir, VecS& ordered);
+
+// Find Module Interfaces of the Object Sources (Mapper Written; Sources Returned Interfaces Before Their Importers)
+VecS ScanModules(Project& project, const VecS& objSrcNames);
+
+// Module Flags, Interface Objects Waited For, and Why the Object Rebuilds (Imported BMI Rebuilt or Newer, Own BMI Missing); False Unless a Module Unit
+bool ModuleDeps(Project& project, const String& srcFile, const String& objFile, String& flags, VecS& after, String& reason);
+
+
+/////////////////
+// Build Files //
+/////////////////
+
+// Build File Generator (ninja; Empty When Building, Else Every Output is Collected as Missing, So Jobs Make the Whole Graph)
+String GenMode;
+
+// Planning Only (Library Plan; Nothing is Written or Removed)
+bool PlanOnly = false;
+
+// Outputs Planned as Missing (Qualified; Left by Interrupted Jobs, or Built From Generated Files or Stamps That Would Change)
+SetS PlannedMissing;
+
+// Output Missing (Always When Generating a Build File, and When Planned as Missing)
+bool Missing(const String& output);
+
+// Escape Path for a ninja Build Line ($, Space and Colon)
+String NinjaPath(const String& path);
+
+// Escape Paths for a ninja Build Line
+String NinjaPaths(const VecS& paths);
+
+// Escape Value of a ninja Variable ($)
+String NinjaValue(const String& value);
+
+// Write build.ninja in the Top Directory From the Jobs of Every Project (Rewritten Only When Its Content Changes)
+void GenerateNinja(const String& top, VecP& projects, const VecJ& jobs);
+
+
+//////////
+// Runs //
+//////////
+
+// Apply Options (Spawn Size, Placement, Priority, Modes, Budgets, Remote Workers and Cache; Returns the Spawn Size)
+int ApplyOptions();
+
+// Load Projects (Every Project of a Workspace in Dependency Order, Else the One Recipe)
+void LoadProjects(const String& recipe, VecP& projects);
+
+// Configure Projects (Settings, and the Job Server When LTO Links Take Tokens)
+void ConfigureProjects(VecP& projects, int nSpawn);
+
+// Collect Jobs of Every Project (One Graph, Links Wait for the Libraries They Use)
+void CollectJobs(VecP& projects, VecJ& jobs, VecJ& ppJobs, VecS& traceFiles);
+
+// Build Jobs, Run Unit-Tests and Record the Run (Returns True When a Project Failed)
+bool BuildJobs(VecP& projects, VecJ& jobs, int nSpawn, double start, SetS& failedOutputs, MapSD& run);
+
+
+/////////////
+// Library //
+/////////////
+
+// Host Process When Embedded (Errors Throw There, Forked Jobs Exit; No Colors), 0 on the Command Line
+pid_t HostPid = 0;
+
+// Output Captured by the Current Call (-1 Outside Calls)
+int LogFd = -1;
+
+// Build State (Every Global a Run Sets; Swapped Out Around Each Call of a Context)
+struct State
+{
+	// Recipe and Project
+	VecS    args;
+	VecVecS lines;
+	MapSV   variables;
+	VecS    inclDirs;
+	String  recipeName;
+	String  prefix;
+	String  stateDir;
+	String  projectDir;
+
+	// Caches (Kept Warm by a Context)
+	PathTable                     paths;
+	int                           statGeneration;
+	std::map<String, int>         inclResolved;
+	std::map<String, InclContext> inclContexts;
+	String                        inclContextKey;
+
+	// History and Results
+	MapSJS history;
+	VecJS  runStats;
+	MapSV  testResults;
+	std::map<String, std::pair<int, String> > headerPrints;
+	std::map<int, ModuleUnit> moduleUnits;
+	MapSS  reasons;
+	int    journalFd;
+
+	// Counters
+	long statHits;
+	long statMisses;
+	long inclHits;
+	long inclScans;
+	long outputsChecked;
+	long testsRun;
+	long testsSkipped;
+	long cacheHits;
+	long jobsCutOff;
+
+	// Targets
+	VecS targets;
+	VecS targetPaths;
+	SetS targetsMatched;
+	bool includeTargets;
+	SetI selected;
+
+	// Options
+	bool              naiveOrder;
+	bool              fingerprintMode;
+	bool              explainMode;
+	String            analyzeMode;
+	long              memBudget;
+	int               linkSpawn;
+	int               compileSpawn;
+	std::vector<VecI> cpuNodes;
+	String            pinMode;
+	RemoteExecutor*   remote;
+	RemoteCache*      cache;
+	String            cacheStore;
+	String            genMode;
+	bool              planOnly;
+	SetS              plannedMissing;
+	int               jobNice;
+
+	// Job Server (Pipe and Own Read End)
+	int jobServerFds[2];
+	int jobServerRead;
+
+	State();
+	~State();
+};
+
+// Swap State With the Globals
+void SwapState(State& state);
+
+// Swap the Caches a Context Keeps Warm (Paths, Stats and Includes) With the Globals
+void SwapCaches(State& state);
+
+// Forget Stats, and the Includes of Files Changed Since the Last Call (Names are Resolved Afresh)
+void RefreshPaths();
+
+// Output Captured So Far by the Current Call
+String CapturedLog();
+
+// Context State (Directory, Options and Warm Caches)
+struct bake::Context::Impl
+{
+	String        dir;
+	bake::Options options;
+	State         caches;
+};
+
+// Call of a Context (Enters Its Directory, Captures Output, Swaps Its State In; Undone on Return or Throw)
+struct Call
+{
+	bake::Context::Impl& context;
+
+	State saved;  // Globals Before the Call
+	int   cwd;    // Directory Before the Call
+	int   out;    // Standard Output Before the Call
+	int   err;    // Standard Error Before the Call
+	int   log;    // Captured Output (Unlinked File, Shared With Forked Jobs)
+
+	bool   hadMakeflags;  // Host's MAKEFLAGS (A Job Server Advertises Its Own)
+	String makeflags;
+
+	Call(bake::Context::Impl& context);
+	~Call();
+};
+
+// Plan Jobs of a Call (Options, Targets, Projects, History, Settings, Jobs of the Selected Outputs; Returns the Spawn Size)
+int PlanCall(const VecS& targets, VecP& projects, VecJ& jobs);
+
+// Jobs as the Library Describes Them
+std::vector<bake::Job> ApiJobs(const VecJ& jobs);
+
+
+//////////
+// Main //
+//////////
+
+#ifndef BAKE_LIBRARY
+
+int main(int argc, char* argv[])
+{
+    // Start of Run
+    double pStart = Now();
+
+    // Get Args
+    for (int a = 1; a < argc; a++)
+    {
+        args.push_back(argv[a]);
+    }
+
+    // Help
+    if (IsOn("h"))
+    {
+        std::cerr << std::endl;
+        std::cerr << "Usage: bake [clean] [app|unit-test|output|source|header ...]" << std::endl;
+        std::cerr << "------------" << std::endl;
+        std::cerr << "-h help"      << std::endl;
+        std::cerr << "-r=Recipe.cfg (Default is Recipe.cfg)" << std::endl;
+        std::cerr << "-workspace=Workspace.cfg (Build Every Project of a Workspace Together)" << std::endl;
+        std::cerr << "-j=SpawnSize  (Default is 1, auto is the CPU Limit; Capped to a cgroup or cpuset Limit)" << std::endl;
+        std::cerr << "-pin=Mode     (off, node or core; Spread Jobs Over NUMA Nodes and Pin Them, Default is off)" << std::endl;
+        std::cerr << "-nice[=N]     (Lower CPU and I/O Priority for Background Builds, Default N is 10)" << std::endl;
+        std::cerr << "-remote=host[:port][/slots],... (Compile Objects on bake-worker Daemons)" << std::endl;
+        std::cerr << "-cache=[http://]host[:port][/path] (Fetch and Store Outputs in a bake-cache Server)" << std::endl;
+        std::cerr << "-cachepolicy=Policy (read, write or readwrite; Default is readwrite)" << std::endl;
+        std::cerr << "-top=N        (Print the N Slowest and Largest Jobs of the Run)" << std::endl;
+        std::cerr << "-history      (Print the Slowest and Largest Jobs on Record)" << std::endl;
+        std::cerr << "-stats[=json] (Print Trends of the Last -top=N Runs and Regressions of the Latest)" << std::endl;
+        std::cerr << "-threshold=P  (Regression Threshold for -stats in Percent, Default is 25)" << std::endl;
+        std::cerr << "-naive        (Start Jobs in Directory Order, Not by Critical Path)" << std::endl;
+        std::cerr << "-mem=MB       (Memory Budget for Jobs, Default is Available or cgroup Memory)" << std::endl;
+        std::cerr << "-jlink=N      (Concurrent Links, Default is -j)" << std::endl;
+        std::cerr << "-jcompile=N   (Concurrent Compiles, Default is -j)" << std::endl;
+        std::cerr << "-batch=N      (Compile Up To N Objects per Compiler Invocation, Default is the Recipe's CompileBatch, Else 1)" << std::endl;
+        std::cerr << "-alltests     (Run Every Unit-Test, Not Just Those With Changed Inputs)" << std::endl;
+        std::cerr << "-explain      (Print Why Each Job Runs)" << std::endl;
+        std::cerr << "-fingerprint  (Headers Changed Only in Comments or Whitespace Don't Rebuild, Recipe: HeaderFingerprints on)" << std::endl;
+        std::cerr << "-impact       (Rank Headers by Rebuild Fan-Out and Cost, -top=N Rows)" << std::endl;
+        std::cerr << "-analyze[=trace] (Report Preprocessed TU Sizes, and Compiler Timings With trace)" << std::endl;
+        std::cerr << "-lto=Mode     (off, full or thin; Default is the Recipe's LTO, Else off)" << std::endl;
+        std::cerr << "-split-dwarf=Mode (off, on or package; Default is the Recipe's SplitDwarf, Else off)" << std::endl;
+        std::cerr << "-affected     (Print the Outputs Depending on the Given Sources, Headers or Targets)" << std::endl;
+        std::cerr << "-gen=ninja    (Write build.ninja, Regenerated by ninja When Recipes or Source Directories Change)" << std::endl;
+        std::cerr << std::endl;
+        std::cerr << "Usage: bake-worker (or bake -worker)" << std::endl;
+        std::cerr << "------------" << std::endl;
+        std::cerr << "-port=Port    (Default is " << WorkerPort << ")" << std::endl;
+        std::cerr << "-bind=Address (Default is 127.0.0.1; Other Addresses Let Any Host Reaching Them Compile)" << std::endl;
+        std::cerr << "-compilers=Compiler,... (Compilers Requests May Run, Default is " << WorkerDefaultCompilers << ")" << std::endl;
+        std::cerr << "-root=Dir     (Include Directories Requests May Name Lie Under It; Other Flags Naming Paths are Refused)" << std::endl;
+        std::cerr << "-j=SpawnSize  (Default is 1)" << std::endl;
+        std::cerr << std::endl;
+        std::cerr << "Usage: bake-cache (or bake -cacheserver)" << std::endl;
+        std::cerr << "------------" << std::endl;
+        std::cerr << "-port=Port    (Default is " << CachePort << ")" << std::endl;
+        std::cerr << "-bind=Address (Default is 127.0.0.1; Other Addresses Let Any Host Reaching Them Read and Store)" << std::endl;
+        std::cerr << "-store=Dir    (Default is " << CacheStore << ")" << std::endl;
+        std::cerr << "-maxsize=MB   (Largest Stored Output, Default is " << CacheMaxSize / (1024 * 1024) << ")" << std::endl;
+        std::cerr << "-j=SpawnSize  (Default is 1)" << std::endl;
+        std::cerr << std::endl;
+        exit(0);
+    }
+
+    // Default Recipe
+    String pRecipe = "Recipe.cfg";
+
+    // Override Recipe
+    if (HasOpt("r"))
+    {
+        pRecipe = GetOpt("r");
+    }
+
+    // Options (Spawn Size, Placement, Priority, Modes, Budgets, Remote Workers and Cache)
+    int pSpawn = ApplyOptions();
+
+    // Targets (Positional Arguments Other Than clean)
+    for (int a = 0; a < args.size(); a++)
+    {
+        if (args[a].empty() || args[a][0] == '-' || (a == 0 && args[a] == "clean"))
+        {
+            continue;
+        }
+
+        AddTarget(args[a], HasOpt("workspace"));
+    }
+
+    // Worker Daemon
+    if (EndsWith(argv[0], "bake-worker") || IsOn("worker"))
+    {
+        String pBind = HasOpt("bind") ? GetOpt("bind") : "127.0.0.1";
+        String pPort = HasOpt("port") ? GetOpt("port") : WorkerPort;
+        WorkerCompilers = SplitOn(HasOpt("compilers") ? GetOpt("compilers") : WorkerDefaultCompilers, ',');
+        WorkerRoot      = HasOpt("root") ? NormalizePath(AbsPath(GetOpt("root"))) : "";
+        RunWorker(pBind, pPort, pSpawn);
+        exit(0);
+    }
+
+    // Cache Server
+    if (EndsWith(argv[0], "bake-cache") || IsOn("cacheserver"))
+    {
+        String pBind = HasOpt("bind") ? GetOpt("bind") : "127.0.0.1";
+        String pPort = HasOpt("port") ? GetOpt("port") : CachePort;
+        CacheStore   = HasOpt("store") ? GetOpt("store") : CacheStore;
+
+        size_t pMaxSize = 0;
+        if (HasOpt("maxsize") && (!ParseLength(GetOpt("maxsize"), MaxMessage >> 20, pMaxSize) || pMaxSize == 0))
+        {
+            std::cerr << "Bad value for -maxsize, must be a number of MB from 1 to " << (MaxMessage >> 20) << " not " << GetOpt("maxsize") << std::endl;
+            Abort();
+        }
+        CacheMaxSize = HasOpt("maxsize") ? pMaxSize << 20 : CacheMaxSize;
+        RunCacheServer(pBind, pPort, pSpawn);
+        exit(0);
+    }
+
+    /////////////
+    // Recipes //
+    /////////////
+
+    // Top Directory (Workspace Projects Enter Their Own)
+    String pTop = AbsPath(".");
+
+    // Projects (Every Project of a Workspace in Dependency Order, Else the One Recipe)
+    VecP projects;
+    LoadProjects(pRecipe, projects);
+
+    // Clean - Special Processing
+    if (args.size() >= 1 && args[0] == "clean")
+    {
+        for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
+        {
+            UseProject(*p);
+            CleanProject();
+        }
+
+        // Finished
+        exit(0);
+    }
+
+    /////////////////
+    // Recipe Name //
+    /////////////////
+
+    // Prefix of the Whole Build (Workspace or Recipe)
+    String pPrefix = Prefix;
+    std::cout << Prefix << std::endl;
+
+    /////////////
+    // History //
+    /////////////
+
+    LoadHistory();
+
+    // Header Fingerprints
+    FingerprintMode = FingerprintMode || IsOn("fingerprint");
+    if (FingerprintMode)
+    {
+        LoadHeaderPrints();
+    }
+
+    // Report Only
+    if (IsOn("history"))
+    {
+        VecJS stats;
+        for (MapSJS::iterator h = History.begin(); h != History.end(); ++h)
+        {
+            stats.push_back(h->second);
+        }
+
+        ReportJobs(stats, HasOpt("top") ? Max(atoi(GetOpt("top").c_str()), 1) : 10);
+        exit(0);
+    }
+
+    // Run Trends and Regressions Only
+    if (IsOn("stats") || HasOpt("stats"))
+    {
+        double threshold = HasOpt("threshold") ? atof(GetOpt("threshold").c_str()) / 100 : 0.25;
+        ReportRuns(HasOpt("top") ? Max(atoi(GetOpt("top").c_str()), 1) : 10, threshold, HasOpt("stats") && GetOpt("stats") == "json");
+        exit(0);
+    }
+
+    // Interrupted Build
+    ResumeJournal();
+
+    //////////////
+    // Settings //
+    //////////////
+
+    ConfigureProjects(projects, pSpawn);
+
+    // Header Impact Report
+    if (IsOn("impact"))
+    {
+        for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
+        {
+            UseProject(*p);
+            ReportImpact(p->objSrcDir, p->objBinDir, !p->objLibShared, HasOpt("top") ? Max(atoi(GetOpt("top").c_str()), 1) : 20);
+        }
+        exit(0);
+    }
+
+    //////////////////////
+    // Compile Analysis //
+    //////////////////////
+
+    // Preprocess Jobs (Every TU) and Compiler Timing Files (Every Object)
+    VecJ ppJobs;
+    VecS traceFiles;
+
+    ///////////
+    // Build //
+    ///////////
+
+    // Jobs of Every Project (One Graph, Links Wait for the Libraries They Use)
+    VecJ jobs;
+    CollectJobs(projects, jobs, ppJobs, traceFiles);
+
+    // Build File Only
+    if (!GenMode.empty())
+    {
+        Prefix = pPrefix;
+        GenerateNinja(pTop, projects, jobs);
+        exit(0);
+    }
+
+    // Affected Outputs Only
+    if (IsOn("affected"))
+    {
+        Prefix = pPrefix;
+        ReportAffected();
+        exit(0);
+    }
+
+    // Requested Subgraph
+    SelectJobs(jobs);
+
+    // Spawn Builds, Run Unit-Tests and Record the Run
+    Prefix = pPrefix;
+    SetS failedOutputs;
+    MapSD run;
+    bool failed = BuildJobs(projects, jobs, pSpawn, pStart, failedOutputs, run);
+
+    // Report Compile Costs
+    if (!AnalyzeMode.empty())
+    {
+        ReportCompileCost(ppJobs, traceFiles, pSpawn, HasOpt("top") ? Max(atoi(GetOpt("top").c_str()), 1) : 15);
+    }
+
+    // Report Jobs of This Run
+    if (HasOpt("top"))
+    {
+        ReportJobs(RunStats, Max(atoi(GetOpt("top").c_str()), 1));
+    }
+
+
+    return failed ? 1 : 0;
+}
+
+#endif // BAKE_LIBRARY
+
+
+
+
+
+
+///////////////////////////
+// Helper Implementation //
+///////////////////////////
+
+// Max
+int Max(int a, int b)
+{
+	return (a > b) ? a : b;
+}
+
+// Abort Run (Exits, or Throws bake::Error When Embedded)
+void Abort()
+{
+	// Command Line
+	if (!HostPid)
+	{
+		exit(1);
+	}
+
+	// Forked Job of a Host (Leaves Without Unwinding Into the Host)
+	fflush(0);
+	if (getpid() != HostPid)
+	{
+		_exit(1);
+	}
+
+	// Last Line Printed (The Error)
+	String log   = CapturedLog();
+	size_t end   = log.find_last_not_of('\n');
+	size_t begin = (end == String::npos) ? 0 : log.rfind('\n', end) + 1;
+
+	throw bake::Error(end == String::npos ? "bake failed" : log.substr(begin, end - begin + 1));
+}
+
+// Join Paths
+String Join(const String& a, const String& b)
+{
+	return a + "/" + b;
+}
+
+// Get Directory
+String GetDir(const String& path)
+{
+	int final = -1;
+	int i = 0;
+	while (i < path.size())
+	{
+		if (path[i] == '/')
+		{
+			final = i;
+		}
+
+		i++;
+	}
+
+	if (final == -1)
+	{
+		return "./";
+	}
+
+	return path.substr(0, final);
+}
+
+// Join Paths
+String Join(const String& a, const String& b, const String& c)
+{
 	return a + "/" + b + "/" + c;
 }
 
-// Concatenate VecS
-String Concat(const VecS& vecS)
-{
-	String result;
+// Concatenate VecS
+String Concat(const VecS& vecS)
+{
+	String result;
+
+	for (VecS::const_iterator s = vecS.begin(); s != vecS.end(); ++s)
+	{
+		if (s != vecS.begin())
+		{
+			result += " ";
+		}
+
+		result += *s;
+	}
+
+	return result;
+}
+
+// Concatenate SetS
+String Concat(const SetS& setS)
+{
+	String result;
+
+	for (SetS::const_iterator s = setS.begin(); s != setS.end(); ++s)
+	{
+		if (s != setS.begin())
+		{
+			result += " ";
+		}
+
+		result += *s;
+	}
+
+	return result;
+}
+
+// Split
+VecS Split(const String& line)
+{
+	VecS result;
+	std::stringstream stream(line);
+
+	String token;
+	while (stream >> token)
+	{
+		result.push_back(token);
+	}
+
+	return result;
+}
+
+// Split on Delimiter
+VecS SplitOn(const String& str, char delim)
+{
+	VecS result;
+	std::stringstream stream(str);
+
+	String token;
+	while (getline(stream, token, delim))
+	{
+		if (!token.empty())
+		{
+			result.push_back(token);
+		}
+	}
+
+	return result;
+}
+
+// Display SetS
+String ToStr(const SetS& setS)
+{
+	String result = "Set:";
+
+	for (SetS::const_iterator s = setS.begin(); s != setS.end(); ++s)
+	{
+		result += " " + *s;
+	}
+
+	return result;
+}
+
+// Ends-With
+bool EndsWith(const String& str, const String& ending)
+{
+	if (str.size() >= ending.size())
+	{
+		if (str.substr(str.size() - ending.size(), ending.size()) == ending)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Starts-With
+bool StartsWith(const String& str, const String& start)
+{
+	return str.compare(0, start.size(), start) == 0;
+}
+
+// File-Exists (Cached Stat)
+bool FileExists(const String& path)
+{
+	int id = PathId(path);
+	StatPath(id);
+	return Paths.isFile[id];
+}
+
+// File Modification Date (Cached Stat)
+int GetFileModTm(const String& filename)
+{
+	int id = PathId(filename);
+	StatPath(id);
+	return Paths.modTm[id];
+}
+
+// File Modification Date
+int GetFileModTm(const SetS& filenames)
+{
+	int result = 0;
+	for (SetS::const_iterator f = filenames.begin(); f != filenames.end(); ++f)
+	{
+		int modTime = GetFileModTm(*f);
+		if (modTime > result)
+		{
+			result = modTime;
+		}
+	}
+	return result;
+}
+
+// File Modification Date (Path Ids)
+int GetFileModTm(const VecI& files)
+{
+	int result = 0;
+	for (VecI::const_iterator f = files.begin(); f != files.end(); ++f)
+	{
+		int modTime = InclModTm(*f);
+		if (modTime > result)
+		{
+			result = modTime;
+		}
+	}
+	return result;
+}
+
+// Is Option On
+bool IsOn(const String& key)
+{
+	for (int a = 0; a < args.size(); a++)
+	{
+		if (args[a] == "-" + key)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Has Option
+bool HasOpt(const String& key)
+{
+	for (int a = 0; a < args.size(); a++)
+	{
+		String arg = args[a];
+		if (arg.size() > 1 + key.size() + 1)
+		{
+			// Find -key=Value
+			if (arg.substr(0, 1 + key.size() + 1) == "-" + key + "=")
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Get Option
+String GetOpt(const String& key)
+{
+	for (int a = 0; a < args.size(); a++)
+	{
+		String arg = args[a];
+		if (arg.size() > 1 + key.size() + 1)
+		{
+			// Find -key=Value
+			if (arg.substr(0, 1 + key.size() + 1) == "-" + key + "=")
+			{
+				return arg.substr(1 + key.size() + 1, arg.size() - 1 - key.size() - 1);
+			}
+		}
+	}
+
+	std::cerr << "Missing Option: " << key << std::endl;
+	Abort();
+}
+
+// Get Value from Recipe
+String GetVal(const String& key)
+{
+	for (int i = 0; i < lines.size(); i++)
+	{
+		const VecS& tokens = lines[i];
+
+		if (tokens[0] == key)
+		{
+			return tokens[1];
+		}
+	}
+
+	std::cerr << "Can't find key in recipe: " << key << std::endl;
+	Abort();
+}
+
+// Get Values from Recipe
+VecS GetVals(const String& key)
+{
+	VecS result;
+
+	for (int i = 0; i < lines.size(); i++)
+	{
+		const VecS& tokens = lines[i];
+
+		if (tokens[0] == key)
+		{
+			for (int r = 1; r < tokens.size(); r++)
+			{
+				result.push_back(tokens[r]);
+			}
+		}
+	}
+
+	if (result.empty())
+	{
+		std::cerr << "Can't find key in recipe: " << key << std::endl;
+		Abort();
+	}
+
+	return result;
+}
+
+// Get Multiple Values from Recipe
+VecVecS GetValsM(const String& key)
+{
+	VecVecS result;
+
+	for (int i = 0; i < lines.size(); i++)
+	{
+		const VecS& tokens = lines[i];
+
+		if (tokens[0] == key)
+		{
+			VecS match;
+			for (int r = 1; r < tokens.size(); r++)
+			{
+				match.push_back(tokens[r]);
+			}
+			result.push_back(match);
+		}
+	}
+
+	return result;
+}
+
+
+// Has Value in Recipe
+bool HasVal(const String& key)
+{
+	for (int i = 0; i < lines.size(); i++)
+	{
+		if (lines[i][0] == key)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Get Value from Recipe (With Default)
+String GetValOr(const String& key, const String& def)
+{
+	if (HasVal(key))
+	{
+		return GetVal(key);
+	}
+
+	return def;
+}
+
+// Resolved Include Names (Name to Path Id, -1 When Not in an Include Directory)
+std::map<String, int> InclResolved;
+
+// Get Direct Includes (Path Ids, Sorted, Scanned Once)
+const VecI& GetIncls(int file)
+{
+	if (Paths.scanned[file])
+	{
+		InclHits++;
+		return Paths.incls[file];
+	}
+	Paths.scanned[file] = true;
+	InclScans++;
+
+	// Collected Aside (Interning Below May Grow the Table)
+	VecI result;
+	std::ifstream stream(Paths.Path(file));
+
+	// Text (For the Fingerprint)
+	String text;
+
+	String line;
+	while (getline(stream, line))
+	{
+		if (FingerprintMode)
+		{
+			text += line;
+			text += '\n';
+		}
+
+		if (line.compare(0, 8, "#include") == 0)
+		{
+			VecS tokens = Split(line);
+			if (tokens.size() >= 2)
+			{
+				String include = tokens[1];
+				if (include.size() > 2)
+				{
+					include = include.substr(1, include.size() - 2);
+
+					// Find Exact File (Search Include Directories, Once per Name)
+					std::map<String, int>::iterator find = InclResolved.find(include);
+					if (find == InclResolved.end())
+					{
+						int resolved = -1;
+						for (VecS::iterator i = inclDirs.begin(); i != inclDirs.end(); ++i)
+						{
+							String candidate = Join(*i, include);
+							if (FileExists(candidate))
+							{
+								resolved = PathId(candidate);
+								break;
+							}
+						}
+
+						find = InclResolved.insert(std::make_pair(include, resolved)).first;
+					}
+
+					if (find->second >= 0)
+					{
+						result.push_back(find->second);
+					}
+				}
+			}
+		}
+	}
+
+	// Fingerprint
+	if (FingerprintMode)
+	{
+		RecordPrint(file, text);
+	}
+
+	// Sorted Adjacency
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+
+	Paths.incls[file].swap(result);
+	return Paths.incls[file];
+}
+
+// Get Direct and Implied Includes (Path Ids, Sorted)
+void GetAllIncls(int file, VecI& result)
+{
+	result.clear();
+
+	// Visit Mark for This Walk
+	static int walk = 0;
+	walk++;
+
+	// Walk Include Edges (The File Itself is Not Its Own Include)
+	Paths.mark[file] = walk;
+	VecI pending(1, file);
+	while (!pending.empty())
+	{
+		int next = pending.back();
+		pending.pop_back();
+
+		// Copied, Scanning May Grow the Table
+		VecI incls = GetIncls(next);
+		for (VecI::iterator i = incls.begin(); i != incls.end(); ++i)
+		{
+			if (Paths.mark[*i] != walk)
+			{
+				Paths.mark[*i] = walk;
+				result.push_back(*i);
+				pending.push_back(*i);
+			}
+		}
+	}
+
+	std::sort(result.begin(), result.end());
+}
+
+// Make-Directory (Not When Only Planning)
+void MkDir(const String& dir)
+{
+	if (PlanOnly)
+	{
+		return;
+	}
+
+	String cmd = "mkdir -p " + dir;
+	int rc = system(cmd.c_str());
+}
+
+// Chop-Ending
+String ChopEnd(const String& str, int end)
+{
+	if ((int)str.size() <= end)
+	{
+		return "";
+	}
+
+	return str.substr(0, str.size() - end);
+}
+
+// Flatten Path Into One File Name
+String FlatName(const String& path)
+{
+	String result = path;
+	for (int i = 0; i < result.size(); i++)
+	{
+		if (result[i] == '/' || result[i] == '.')
+		{
+			result[i] = '_';
+		}
+	}
+
+	return result;
+}
+
+// Pick Next Job for Executor (Prefers Jobs No Other Executor Can Run, Background Jobs Last)
+int PickJob(const VecJ& jobs, const std::vector<bool>& started, const VecI& waiting, const std::vector<Executor*>& executors, Executor* exec, Admission& admission)
+{
+	int fallback   = -1;
+	int background = -1;
+
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		// Already Started, Waiting on Inputs, Not Accepted or Not Admitted
+		if (started[j] || waiting[j] > 0 || !exec->Accepts(jobs[j]) || !admission.Admits(jobs[j], exec->IsLocal()))
+		{
+			continue;
+		}
+
+		// Background (Only When Nothing Else Can Start)
+		if (jobs[j].background)
+		{
+			background = (background < 0) ? j : background;
+			continue;
+		}
+
+		// Exclusive to This Executor
+		bool exclusive = true;
+		for (int e = 0; e < executors.size(); e++)
+		{
+			if (executors[e] != exec && executors[e]->Accepts(jobs[j]))
+			{
+				exclusive = false;
+				break;
+			}
+		}
+
+		if (exclusive)
+		{
+			return j;
+		}
+
+		// First Shared Job
+		if (fallback < 0)
+		{
+			fallback = j;
+		}
+	}
+
+	return fallback >= 0 ? fallback : background;
+}
+
+// Pick Batch for a Compile (Ready Compiles Sharing Its Batch Command, Up to an Even Share of Them Over the Slots, So the Tail Stays Balanced; No More Than Admission Allows)
+VecI PickBatch(const VecJ& jobs, int first, const std::vector<bool>& started, const VecI& waiting, const std::vector<bool>& solo, int nSpawn, const Admission& admission)
+{
+	// Ready Compiles Sharing the Batch Command (Longest First)
+	VecI ready(1, first);
+	double total = jobs[first].cost;
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		if (j != first && !started[j] && waiting[j] == 0 && !solo[j] && jobs[j].batchCmd == jobs[first].batchCmd)
+		{
+			ready.push_back(j);
+			total += jobs[j].cost;
+		}
+	}
+
+	// Even Share (By Count, and By Estimated Cost When Known)
+	int    most  = Max(1, std::min(jobs[first].batchMax, (int)(ready.size() + nSpawn - 1) / nSpawn));
+	double share = total / nSpawn;
+
+	// Members Admitted Together (Compile Slots and Summed Memory; the First Was Admitted Alone)
+	VecI batch(1, first);
+	double cost   = jobs[first].cost;
+	long   memory = jobs[first].memory;
+	for (int r = 1; r < ready.size() && batch.size() < most; r++)
+	{
+		if (total > 0 && cost + jobs[ready[r]].cost > share)
+		{
+			continue;
+		}
+
+		if (!admission.Admits(JobCompile, batch.size() + 1, memory + jobs[ready[r]].memory, true))
+		{
+			break;
+		}
+
+		batch.push_back(ready[r]);
+		cost   += jobs[ready[r]].cost;
+		memory += jobs[ready[r]].memory;
+	}
+
+	return batch;
+}
+
+// Run Batched Compile (One Compiler Invocation, Objects Named After Their Sources in the Object Directory; Returns Exit Code)
+int RunBatch(const VecJ& jobs, const VecI& batch)
+{
+	// Objects Left by a Member That Fails Would Look Built
+	String cmd = jobs[batch[0]].batchCmd;
+	for (VecI::const_iterator b = batch.begin(); b != batch.end(); ++b)
+	{
+		unlink(jobs[*b].output.c_str());
+		cmd += " " + AbsPath(jobs[*b].source);
+	}
+
+	std::cout << Prefix << FgGrn() << "Executing: " << FgOff() << cmd << std::endl;
+	int rc = System(cmd);
+
+	// Store Built Objects
+	for (VecI::const_iterator b = batch.begin(); b != batch.end() && Cache && Cache->write; ++b)
+	{
+		if (!jobs[*b].cacheBase.empty() && access(jobs[*b].output.c_str(), F_OK) == 0)
+		{
+			Cache->Put(CacheKey(jobs[*b]), jobs[*b].output);
+		}
+	}
+
+	return rc;
+}
+
+// Note Output Before a Job Runs
+Prior NotePrior(const String& output)
+{
+	Prior prior;
+
+	if (access(output.c_str(), F_OK) == 0)
+	{
+		prior.hash = HashFile(output);
+	}
+
+	return prior;
+}
+
+// Output Rebuilt Byte-Identical
+bool SameAsPrior(const String& output, const Prior& prior)
+{
+	return !prior.hash.empty() && access(output.c_str(), F_OK) == 0 && HashFile(output) == prior.hash;
+}
+
+// Read a Job's Report (One Flag per Member, '1' When Its Output Came Out Byte-Identical) and Close It
+String ReadReport(int fd)
+{
+	String report;
+
+	char buffer[256];
+	ssize_t n;
+	while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+	{
+		report.append(buffer, n);
+	}
+
+	close(fd);
+	return report;
+}
+
+// Path Id of a Job's Output (In Its Directory; Job Graph Key)
+int OutputId(const Job& job)
+{
+	return Paths.Intern(InDir(job.dir, job.output));
+}
+
+// Path Ids of Qualified Paths (Interned As They Are, Not Qualified Again)
+VecI QualifiedIds(const VecS& paths)
+{
+	VecI ids;
+	for (VecS::const_iterator p = paths.begin(); p != paths.end(); ++p)
+	{
+		ids.push_back(Paths.Intern(*p));
+	}
+	return ids;
+}
+
+// Paths of Path Ids
+VecS PathStrs(const VecI& ids)
+{
+	VecS paths;
+	for (VecI::const_iterator i = ids.begin(); i != ids.end(); ++i)
+	{
+		paths.push_back(PathStr(*i));
+	}
+	return paths;
+}
+
+// Job Graph (Unfinished Inputs of Each Job, and the Jobs Waiting on It; Inputs Not in the Set are Ready)
+void JobGraph(const VecJ& jobs, VecI& waiting, std::vector<VecI>& dependents)
+{
+	// Jobs by Output Path Id (-1 When No Job Builds It; Inputs Were Interned Before the Outputs)
+	VecI outputs(jobs.size());
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		outputs[j] = OutputId(jobs[j]);
+	}
+
+	VecI byOutput(Paths.Size(), -1);
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		byOutput[outputs[j]] = j;
+	}
+
+	waiting.assign(jobs.size(), 0);
+	dependents.assign(jobs.size(), VecI());
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		for (VecI::const_iterator a = jobs[j].after.begin(); a != jobs[j].after.end(); ++a)
+		{
+			if (byOutput[*a] >= 0)
+			{
+				waiting[j]++;
+				dependents[byOutput[*a]].push_back(j);
+			}
+		}
+	}
+}
+
+// Spawn Set of Jobs (Returns Number of Failed Jobs, Whose Outputs are Added to failedOutputs)
+int Spawn(const VecJ& unordered, int nSpawn, SetS* failedOutputs)
+{
+	// Jobs on the Longest Remaining Path First
+	VecJ jobs = OrderJobs(unordered, nSpawn);
+
+	// Journal (Write-Ahead: Started Before the Fork, Finished After the Wait)
+	if (!jobs.empty())
+	{
+		OpenJournal();
+	}
+
+	// Unfinished Inputs of Each Job, and the Jobs Waiting on It
+	VecI waiting;
+	std::vector<VecI> dependents;
+	JobGraph(jobs, waiting, dependents);
+
+	// Executors (Remote First, Local Last)
+	LocalExecutor local(nSpawn);
+	std::vector<Executor*> executors;
+	if (Remote)
+	{
+		executors.push_back(Remote);
+	}
+	executors.push_back(&local);
+
+	// Running Jobs (By Process Id)
+	std::map<int, Running> running;
+
+	// Memory and Concurrency Admission
+	Admission admission;
+
+	// Started Jobs, Batch Members Retried Alone, and Jobs With an Input That Came Out Changed
+	std::vector<bool> started(jobs.size(), false);
+	std::vector<bool> solo(jobs.size(), false);
+	std::vector<bool> inputChanged(jobs.size(), false);
+	int remaining = jobs.size();
+	int failed = 0;
+
+	while (remaining > 0 || !running.empty())
+	{
+		// Fill Free Executor Slots
+		for (int e = 0; e < executors.size(); e++)
+		{
+			Executor* exec = executors[e];
+
+			while (remaining > 0)
+			{
+				// Free Slot
+				int slot = exec->Acquire();
+				if (slot < 0)
+				{
+					break;
+				}
+
+				// Next Job
+				int j = PickJob(jobs, started, waiting, executors, exec, admission);
+				if (j < 0)
+				{
+					exec->Release(slot);
+					break;
+				}
+
+				// Rebuilt Inputs All Came Out Unchanged (Early Cutoff; Output Touched, So It Stays Newer Than Them)
+				if (jobs[j].cutoff && !inputChanged[j])
+				{
+					exec->Release(slot);
+					utimensat(AT_FDCWD, InDir(jobs[j].dir, jobs[j].output).c_str(), 0, 0);
+					std::cout << Prefix << FgBlu() << "Skipped (Inputs Unchanged): " << FgOff() << jobs[j].output << std::endl;
+
+					started[j] = true;
+					remaining--;
+					JobsCutOff++;
+					for (VecI::iterator d = dependents[j].begin(); d != dependents[j].end(); ++d)
+					{
+						waiting[*d]--;
+					}
+					continue;
+				}
+
+				// Batch (Ready Compiles Sharing Its Batch Command, Run Locally)
+				VecI batch;
+				if (exec->IsLocal() && !solo[j] && !jobs[j].batchCmd.empty())
+				{
+					batch = PickBatch(jobs, j, started, waiting, solo, nSpawn, admission);
+					if (batch.size() == 1)
+					{
+						batch.clear();
+					}
+				}
+
+				// Fork and Execute
+				VecI members = batch.empty() ? VecI(1, j) : batch;
+				for (VecI::iterator m = members.begin(); m != members.end(); ++m)
+				{
+					Journal("start", InDir(jobs[*m].dir, jobs[*m].output));
+				}
+				// Report Pipe (Not Inherited by Commands)
+				int report[2];
+				if (pipe(report) != 0)
+				{
+					std::cerr << "Failed to pipe()" << std::endl;
+					Abort();
+				}
+				fcntl(report[0], F_SETFD, FD_CLOEXEC);
+				fcntl(report[1], F_SETFD, FD_CLOEXEC);
+
+				double start = Now();
+				int pid = fork();
+
+				// Error
+				if (pid < 0)
+				{
+					std::cerr << "Failed to fork()" << std::endl;
+					Abort();
+				}
+				// Child
+				else if (pid == 0)
+				{
+					// Project Directory
+					if (!jobs[j].dir.empty() && chdir(jobs[j].dir.c_str()) != 0)
+					{
+						_exit(1);
+					}
+
+					// CPUs of the Slot
+					if (exec->IsLocal())
+					{
+						PlaceWorker(slot);
+					}
+
+					// Priority (Embedded)
+					if (JobNice > 0)
+					{
+						LowerPriority(JobNice);
+					}
+
+					close(report[0]);
+
+					// Outputs Jobs Wait On, Before (Compared After and Reported, For an Early Cutoff)
+					std::vector<Prior> priors;
+					for (VecI::iterator m = members.begin(); m != members.end(); ++m)
+					{
+						priors.push_back(dependents[*m].empty() ? Prior() : NotePrior(jobs[*m].output));
+					}
+
+					// Command's stderr Into Its File (Copied to the Terminal When It Fails)
+					int console = -1;
+					if (batch.empty() && !jobs[j].errFile.empty())
+					{
+						int fd = open(jobs[j].errFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+						if (fd >= 0)
+						{
+							console = dup(2);
+							dup2(fd, 2);
+							close(fd);
+						}
+					}
+
+					int rc = batch.empty() ? CacheRun(exec, jobs[j], slot) : RunBatch(jobs, batch);
+
+					if (console >= 0)
+					{
+						dup2(console, 2);
+						close(console);
+						if (rc != 0)
+						{
+							std::cerr << ReadFile(jobs[j].errFile);
+						}
+					}
+
+					String flags;
+					for (int m = 0; m < members.size(); m++)
+					{
+						flags += (rc == 0 && SameAsPrior(jobs[members[m]].output, priors[m])) ? '1' : '0';
+					}
+					write(report[1], flags.data(), flags.size());
+					fflush(0);
+					_exit(rc == 0 ? 0 : 1);
+				}
+				// Parent
+				else
+				{
+					close(report[1]);
+					running[pid] = Running(j, exec, slot, start);
+					running[pid].batch  = batch;
+					running[pid].report = report[0];
+					admission.Admit(jobs, members, exec->IsLocal());
+					for (VecI::iterator m = members.begin(); m != members.end(); ++m)
+					{
+						started[*m] = true;
+						remaining--;
+					}
+				}
+			}
+		}
+
+		// Nothing Running
+		if (running.empty())
+		{
+			break;
+		}
+
+		int status;
+		rusage usage;
+
+		// Wait for Process to Finish (With Resource Usage)
+		int pid = wait4(-1, &status, 0, &usage);
+		if (pid < 0)
+		{
+			break;
+		}
+
+		// Known Process
+		std::map<int, Running>::iterator find = running.find(pid);
+		if (find != running.end())
+		{
+			// Outputs Rebuilt Byte-Identical (By Member)
+			String report = ReadReport(find->second.report);
+
+			// Journal (Abnormal Termination Stays Started; Recorded Jobs Finish With Command and Wall Time; Batches Below)
+			if (WIFEXITED(status) && find->second.batch.empty())
+			{
+				const Job& job = jobs[find->second.job];
+				std::ostringstream detail;
+				if (WEXITSTATUS(status) == 0 && job.record)
+				{
+					detail << Hash(job.cmd) << " " << Now() - find->second.start;
+				}
+				Journal(WEXITSTATUS(status) == 0 ? "done" : "fail", InDir(job.dir, job.output), detail.str());
+			}
+
+			// Abnormal Termination
+			if (!WIFEXITED(status))
+			{
+				std::cerr << Prefix
+						  << FgRed() << "Execution Failed: " << FgOff()
+						  << FgYlw() << jobs[find->second.job].cmd << FgOff() << std::endl;
+				Abort();
+			}
+
+			// Batch (Members Without an Object are Retried Alone, Which Attributes Their Failure)
+			if (!find->second.batch.empty())
+			{
+				const VecI& batch = find->second.batch;
+
+				// Shares of the Batch (By Estimated Cost, Else Even)
+				double total = 0;
+				for (VecI::const_iterator b = batch.begin(); b != batch.end(); ++b)
+				{
+					total += jobs[*b].cost;
+				}
+
+				for (int m = 0; m < batch.size(); m++)
+				{
+					VecI::const_iterator b = batch.begin() + m;
+					String output = InDir(jobs[*b].dir, jobs[*b].output);
+					double share  = total > 0 ? jobs[*b].cost / total : 1.0 / batch.size();
+
+					// Built
+					if (WEXITSTATUS(status) == 0 || access(output.c_str(), F_OK) == 0)
+					{
+						std::ostringstream detail;
+						detail << Hash(jobs[*b].cmd) << " " << (Now() - find->second.start) * share;
+						Journal("done", output, detail.str());
+
+						RecordStats(jobs[*b], find->second.start, usage, share);
+
+						// Inputs of Waiting Jobs (Changed Unless Rebuilt Byte-Identical)
+						bool changed = m >= report.size() || report[m] != '1';
+						for (VecI::iterator d = dependents[*b].begin(); d != dependents[*b].end(); ++d)
+						{
+							waiting[*d]--;
+							inputChanged[*d] = inputChanged[*d] || changed;
+						}
+					}
+					// Retried Alone
+					else
+					{
+						std::cerr << Prefix << FgYlw() << "Retrying Alone: " << FgOff() << jobs[*b].output << std::endl;
+						solo[*b]    = true;
+						started[*b] = false;
+						remaining++;
+					}
+				}
+			}
+			// Failed Job (Jobs Waiting on It are Skipped)
+			else if (WEXITSTATUS(status) != 0)
+			{
+				VecI pending(1, find->second.job);
+				while (!pending.empty())
+				{
+					int f = pending.back();
+					pending.pop_back();
+
+					failed++;
+					if (failedOutputs)
+					{
+						failedOutputs->insert(InDir(jobs[f].dir, jobs[f].output));
+					}
+
+					for (VecI::iterator d = dependents[f].begin(); d != dependents[f].end(); ++d)
+					{
+						if (!started[*d])
+						{
+							std::cerr << Prefix << FgRed() << "Skipped (Input Failed): " << FgOff() << jobs[*d].output << std::endl;
+							started[*d] = true;
+							remaining--;
+							pending.push_back(*d);
+						}
+					}
+				}
+			}
+			// Successful Job
+			else
+			{
+				// Record
+				if (jobs[find->second.job].record)
+				{
+					RecordStats(jobs[find->second.job], find->second.start, usage);
+				}
+
+				// Inputs of Waiting Jobs (Changed Unless Rebuilt Byte-Identical)
+				bool changed = report.empty() || report[0] != '1';
+				for (VecI::iterator d = dependents[find->second.job].begin(); d != dependents[find->second.job].end(); ++d)
+				{
+					waiting[*d]--;
+					inputChanged[*d] = inputChanged[*d] || changed;
+				}
+			}
+
+			admission.Retire(jobs, find->second.batch.empty() ? VecI(1, find->second.job) : find->second.batch, find->second.exec->IsLocal());
+			find->second.exec->Release(find->second.slot);
+			running.erase(find);
+		}
+	}
+
+	// Persist History, Journal Done
+	if (!jobs.empty())
+	{
+		SaveHistory();
+		CloseJournal();
+	}
+
+	// Outputs Changed
+	InvalidateStats();
+
+	return failed;
+}
+
+// Read Whole File
+String ReadFile(const String& path)
+{
+	std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+	std::ostringstream data;
+	data << stream.rdbuf();
+	return data.str();
+}
+
+// Write Whole File
+bool WriteFile(const String& path, const String& data)
+{
+	InvalidateStats();
+
+	std::ofstream stream(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	stream.write(data.data(), data.size());
+	return stream.good();
+}
+
+// List Files in a Directory
+VecS ListFiles(const String& dir)
+{
+	VecS result;
+
+	// Open Directory
+	DIR* d = opendir(dir.c_str());
+	dirent *ent;
+
+	// Directory Does Not Exist
+	if (!d)
+	{
+		return result;
+	}
+
+	// For Each Entry
+	while (ent = readdir(d))
+	{
+		String filename = ent->d_name;
+		String fullPath = Join(dir, filename);
+
+		// Empty Filename
+		if (filename.empty())
+		{
+			continue;
+		}
+
+		// Exclude Self
+		if (filename[0] == '.')
+		{
+			continue;
+		}
+
+		// Get File Info
+		// Get File Info
+		struct stat st;
+		if (stat(fullPath.c_str(), &st) == -1)
+		{
+			continue;
+		}
+
+		// Not A File
+		if (st.st_mode & S_IFDIR == 0)
+		{
+			continue;
+		}
+
+		// Add File
+		result.push_back(filename);
+	}
+
+	closedir(d);
+	return result;
+}
+
+// System Call
+int System(const String& cmd)
+{
+	return system(cmd.c_str());
+}
+
+// File Size
+long GetFileSize(const String& path)
+{
+	struct stat s;
+	if (path.empty() || stat(path.c_str(), &s) != 0)
+	{
+		return 0;
+	}
+
+	return s.st_size;
+}
+
+// Hash of File Content
+String HashFile(const String& path)
+{
+	return Hash(ReadFile(path));
+}
+
+// Get Absolute Path
+String AbsPath(const String& path)
+{
+	char buffer[PATH_MAX];
+	if (realpath(path.c_str(), buffer))
+	{
+		return buffer;
+	}
+
+	return path;
+}
+
+// Compiler Flags With Path Arguments Made Absolute (False When Other Arguments Name Relative Paths)
+bool AbsFlags(const String& flags, String& absFlags)
+{
+	// Flags Taking a Path Attached or as the Next Argument (Longer Before Their Prefixes), Then Those Taking It After '='
+	static const char* const pathFlags[]  = { "-include-pch", "-include", "-imacros", "-isystem", "-iquote", "-idirafter", "-isysroot", "-iprefix", "-I", "-L", "-B", 0 };
+	static const char* const valueFlags[] = { "--sysroot=", "-fprofile-use=", "-fsanitize-ignorelist=", "-fsanitize-blacklist=", "@", 0 };
+
+	String cwd = AbsPath(".");
+	VecS args = Split(flags);
+	bool known = true;
+	absFlags.clear();
+
+	for (int a = 0; a < args.size(); a++)
+	{
+		String arg = args[a];
+		String flag;
+		String path;
+
+		for (int f = 0; pathFlags[f] && flag.empty(); f++)
+		{
+			if (StartsWith(arg, pathFlags[f]))
+			{
+				flag = pathFlags[f];
+				path = arg.substr(flag.size());
+				if (path.empty() && a + 1 < args.size())
+				{
+					flag += " ";
+					path  = args[++a];
+				}
+			}
+		}
+
+		for (int f = 0; valueFlags[f] && flag.empty(); f++)
+		{
+			if (StartsWith(arg, valueFlags[f]))
+			{
+				flag = valueFlags[f];
+				path = arg.substr(flag.size());
+			}
+		}
+
+		if (!flag.empty())
+		{
+			arg = flag + (path.empty() || path[0] == '/' ? path : Join(cwd, path));
+		}
+		else
+		{
+			// Other Relative Paths (Bare or After '=') Can't Be Told from Values, So Only Existing Ones Count
+			String::size_type eq = arg.find('=');
+			String value = arg[0] != '-' ? arg : eq != String::npos ? arg.substr(eq + 1) : String();
+			if (!value.empty() && value[0] != '/' && access(value.c_str(), F_OK) == 0)
+			{
+				known = false;
+			}
+		}
+
+		absFlags += " " + arg;
+	}
+
+	return known;
+}
+
+// Shared Library Name for Archive
+String SharedLibName(const String& arcName)
+{
+	if (EndsWith(arcName, ".a"))
+	{
+		return ChopEnd(arcName, 2) + ".so";
+	}
+
+	return arcName + ".so";
+}
+
+// Update Stamp File (Rewritten Only When Content Changes; Only Planning, Planned as Missing Instead)
+void UpdateStamp(const String& file, const String& content)
+{
+	// Current Content
+	String current;
+	std::ifstream in(file.c_str());
+	if (in)
+	{
+		getline(in, current);
+	}
+	in.close();
+
+	// Unchanged
+	if (FileExists(file) && current == content)
+	{
+		return;
+	}
+
+	// Only Planning (Outputs Depending on It Rebuild)
+	if (PlanOnly)
+	{
+		PlannedMissing.insert(Qualify(file));
+		return;
+	}
+
+	std::ofstream out(file.c_str());
+	out << content << std::endl;
+	InvalidateStats();
+}
+
+// Get All Library Files
+SetS GetLibFiles()
+{
+	SetS result;
+
+	VecS libPaths = GetVals("LibraryDirs");
+	VecS libNames = GetVals("Libraries");
+
+	for (VecS::iterator p = libPaths.begin(); p != libPaths.end(); ++p)
+	{
+		for (VecS::iterator n = libNames.begin(); n != libNames.end(); ++n)
+		{
+			String sharedObj = Join(*p, "lib" + *n + ".so");
+			String staticArc = Join(*p, "lib" + *n + ".a");
+
+			if (FileExists(sharedObj))
+			{
+				result.insert(sharedObj);
+			}
+
+			if (FileExists(staticArc))
+			{
+				result.insert(staticArc);
+			}
+		}
+	}
+
+	return result;
+}
+
+String FgOn(int color)
+{
+	if (HostPid)
+	{
+		return "";
+	}
+
+	char buffer[20];
+	sprintf(buffer, "%c[38;5;%dm", 0x1B, color);
+	return buffer;
+}
+
+String FgOff()
+{
+	if (HostPid)
+	{
+		return "";
+	}
+
+	char buffer[20];
+	sprintf(buffer, "%c[%dm", 0x1B, 0);
+	return buffer;
+}
+
+String FgRed() { return FgOn(160); }
+String FgBlu() { return FgOn(129); }
+String FgGrn() { return FgOn(150); }
+String FgYlw() { return FgOn(190); }
+String FgSky() { return FgOn(153); }
+String FgOrg() { return FgOn(214); }
+
+String Dashes(int n)
+{
+	return String(n, '-');
+}
+
+String Star()
+{
+	return FgSky() + "* " + FgOff();
+}
+
+void Display(const String& label, const String& target, const String& detail)
+{
+	std::cout << Prefix
+			  << FgBlu() << label  << ": " << FgOff()
+			  << FgYlw() << target << " (" << FgOff()
+			  << FgGrn() << detail         << FgOff()
+			  << FgYlw()           << ")"  << FgOff()
+			  << std::endl;
+}
+
+
+
+/////////////////////////////
+// Executor Implementation //
+/////////////////////////////
+
+// Local Executor
+String LocalExecutor::Name()
+{
+	return "local";
+}
+
+bool LocalExecutor::Accepts(const Job&)
+{
+	return true;
+}
+
+int LocalExecutor::Acquire()
+{
+	if (busy >= nSpawn)
+	{
+		return -1;
+	}
+
+	// Job Server Token (The First Job Runs on the Implicit One)
+	char token;
+	if (busy > 0 && JobServerRead >= 0 && read(JobServerRead, &token, 1) != 1)
+	{
+		return -1;
+	}
+
+	// Lowest Free Slot
+	int slot = 0;
+	while (used[slot])
+	{
+		slot++;
+	}
+
+	used[slot] = true;
+	busy++;
+	return slot;
+}
+
+void LocalExecutor::Release(int slot)
+{
+	used[slot] = false;
+	busy--;
+
+	// Return Job Server Token
+	if (busy > 0 && JobServerRead >= 0 && write(JobServerFds[1], "+", 1) != 1)
+	{
+		std::cerr << "Failed to return job server token" << std::endl;
+	}
+}
+
+// Start Job Server (Tokens Beyond Each Process's Implicit One, Advertised in MAKEFLAGS)
+void StartJobServer(int nSpawn)
+{
+	if (pipe(JobServerFds) != 0)
+	{
+		std::cerr << "Failed to create job server pipe" << std::endl;
+		Abort();
+	}
+
+	// Tokens
+	String tokens(nSpawn - 1, '+');
+	if (write(JobServerFds[1], tokens.data(), tokens.size()) != (int)tokens.size())
+	{
+		std::cerr << "Failed to fill job server pipe" << std::endl;
+		Abort();
+	}
+
+	// Own Read End (Reopened, So Non-Blocking Doesn't Leak to Children)
+	char path[64];
+	sprintf(path, "/proc/self/fd/%d", JobServerFds[0]);
+	JobServerRead = open(path, O_RDONLY | O_NONBLOCK);
+
+	// Advertise to Children
+	char flags[128];
+	sprintf(flags, " -j%d --jobserver-auth=%d,%d --jobserver-fds=%d,%d", nSpawn, JobServerFds[0], JobServerFds[1], JobServerFds[0], JobServerFds[1]);
+	setenv("MAKEFLAGS", flags, 1);
+}
+
+int LocalExecutor::Run(const Job& job, int)
+{
+	std::cout << Prefix << FgGrn() << "Executing: " << FgOff() << job.cmd << job.extra << std::endl;
+	return RunAtomic(job);
+}
+
+// Remote Executor (Spec is host[:port][/slots],...)
+RemoteExecutor::RemoteExecutor(const String& spec)
+{
+	VecS hosts = SplitOn(spec, ',');
+	for (VecS::iterator h = hosts.begin(); h != hosts.end(); ++h)
+	{
+		Worker worker;
+		String address = *h;
+
+		// Slots
+		size_t slash = address.find('/');
+		if (slash != String::npos)
+		{
+			worker.slots = Max(atoi(address.substr(slash + 1).c_str()), 1);
+			address = address.substr(0, slash);
+		}
+
+		// Port
+		size_t colon = address.find(':');
+		if (colon != String::npos)
+		{
+			worker.port = address.substr(colon + 1);
+			address = address.substr(0, colon);
+		}
+		else
+		{
+			worker.port = WorkerPort;
+		}
+
+		worker.host = address;
+		workers.push_back(worker);
+	}
+
+	if (workers.empty())
+	{
+		std::cerr << "Bad format for remote, must be of the form 'host[:port][/slots],...' not " << spec << std::endl;
+		Abort();
+	}
+}
+
+String RemoteExecutor::Name()
+{
+	return "remote";
+}
+
+bool RemoteExecutor::Accepts(const Job& job)
+{
+	return !job.ppCmd.empty() && job.extra.empty();
+}
+
+int RemoteExecutor::Acquire()
+{
+	// Least Loaded Worker
+	int best = -1;
+	for (int w = 0; w < workers.size(); w++)
+	{
+		if (workers[w].busy >= workers[w].slots)
+		{
+			continue;
+		}
+
+		if (best < 0 || workers[w].busy * workers[best].slots < workers[best].busy * workers[w].slots)
+		{
+			best = w;
+		}
+	}
+
+	if (best >= 0)
+	{
+		workers[best].busy++;
+	}
+
+	return best;
+}
+
+void RemoteExecutor::Release(int slot)
+{
+	workers[slot].busy--;
+}
+
+int RemoteExecutor::Run(const Job& job, int slot)
+{
+	const Worker& worker = workers[slot];
+	std::cout << Prefix << FgGrn() << "Executing (" << worker.host << ":" << worker.port << "): " << FgOff() << job.cmd << std::endl;
+
+	// Preprocess Locally
+	int rc = System(job.ppCmd);
+	String source = ReadFile(job.ppFile);
+	unlink(job.ppFile.c_str());
+
+	if (rc != 0)
+	{
+		return rc;
+	}
+
+	// Request (BAKE1 cmdLen srcLen, Command, Source)
+	std::ostringstream request;
+	request << "BAKE1 " << job.ccCmd.size() << " " << source.size() << "\n" << job.ccCmd << source;
+
+	// Connect and Send
+	int fd = Connect(worker.host, worker.port);
+	bool ok = fd >= 0 && SendAll(fd, request.str());
+
+	// Response (BAKE1 rc objLen errLen, Object, Errors)
+	String line;
+	VecS tokens;
+	size_t objLen = 0;
+	size_t errLen = 0;
+	ok = ok && RecvLine(fd, line);
+	if (ok)
+	{
+		tokens = Split(line);
+		ok = tokens.size() == 4 && tokens[0] == "BAKE1";
+		ok = ok && ParseLength(tokens[2], MaxMessage, objLen) && ParseLength(tokens[3], MaxMessage, errLen);
+	}
+
+	String object;
+	String errors;
+	ok = ok && RecvAll(fd, object, objLen);
+	ok = ok && RecvAll(fd, errors, errLen);
+
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+
+	// Fall Back to Local Build
+	if (!ok)
+	{
+		std::cerr << Prefix << FgYlw() << "Worker unavailable, building locally: " << FgOff() << worker.host << ":" << worker.port << std::endl;
+		return RunAtomic(job);
+	}
+
+	// Compiler Diagnostics
+	std::cerr << errors;
+
+	// Object (Written Aside, Then Renamed)
+	rc = atoi(tokens[1].c_str());
+	if (rc == 0 && (!WriteFile(job.output + ".tmp", object) || rename((job.output + ".tmp").c_str(), job.output.c_str()) != 0))
+	{
+		return 1;
+	}
+
+	return rc;
+}
+
+
+///////////////////////////
+// Worker Implementation //
+///////////////////////////
+
+// Serve One Compile Request
+void ServeCompile(int fd)
+{
+	// Request
+	String line;
+	if (!RecvLine(fd, line))
+	{
+		return;
+	}
+
+	VecS tokens = Split(line);
+	if (tokens.size() != 3 || tokens[0] != "BAKE1")
+	{
+		return;
+	}
+
+	size_t cmdLen = 0;
+	size_t srcLen = 0;
+	if (!ParseLength(tokens[1], MaxMessage, cmdLen) || !ParseLength(tokens[2], MaxMessage, srcLen))
+	{
+		return;
+	}
+
+	String cmd;
+	String source;
+	if (!RecvAll(fd, cmd, cmdLen) || !RecvAll(fd, source, srcLen))
+	{
+		return;
+	}
+
+	// Accepted Command Only (Configured Compiler; the Output Flag is Added Here)
+	VecS argv = Split(cmd);
+	String why;
+	if (!WorkerAccepts(argv, why))
+	{
+		std::cout << Prefix << FgRed() << "Rejected: " << FgOff() << why << std::endl;
+
+		String errors = "bake-worker: rejected, " + why + "\n";
+		std::ostringstream response;
+		response << "BAKE1 1 0 " << errors.size() << "\n" << errors;
+		SendAll(fd, response.str());
+		return;
+	}
+
+	// Scratch Directory
+	char scratch[] = "/tmp/bake-worker-XXXXXX";
+	if (!mkdtemp(scratch))
+	{
+		return;
+	}
+
+	String inFile  = Join(scratch, "in.ii");
+	String outFile = Join(scratch, "out.o");
+	String errFile = Join(scratch, "err.txt");
+	WriteFile(inFile, source);
+
+	// Compile Preprocessed Source
+	argv.push_back("-x");
+	argv.push_back("c++-cpp-output");
+	argv.push_back("-c");
+	argv.push_back(inFile);
+	argv.push_back("-o");
+	argv.push_back(outFile);
+
+	std::cout << Prefix << FgGrn() << "Executing: " << FgOff() << Concat(argv) << std::endl;
+	int rc = argv.size() > 6 ? Exec(argv, errFile) : 1;
+
+	// Response
+	String object = (rc == 0) ? ReadFile(outFile) : "";
+	String errors = ReadFile(errFile);
+
+	std::ostringstream response;
+	response << "BAKE1 " << rc << " " << object.size() << " " << errors.size() << "\n" << object << errors;
+	SendAll(fd, response.str());
+
+	// Cleanup
+	unlink(inFile.c_str());
+	unlink(outFile.c_str());
+	unlink(errFile.c_str());
+	rmdir(scratch);
+}
+
+// Run Worker Daemon
+void RunWorker(const String& bindAddr, const String& port, int nSlots)
+{
+	Prefix = FgSky() + "* Bake-Worker: " + FgOff();
+
+	int fd = Listen(bindAddr, port);
+	std::cout << Prefix << "Listening on " << bindAddr << ":" << port << " with " << nSlots << " slots, running " << Concat(WorkerCompilers) << std::endl;
+
+	// Any Peer That Can Connect Runs the Compilers (No Authentication)
+	if (!IsLoopback(bindAddr))
+	{
+		std::cerr << Prefix << FgYlw() << "Warning: " << FgOff() << "listening on a non-loopback address, any host reaching " << bindAddr << ":" << port << " can run the compilers unauthenticated" << std::endl;
+	}
+
+	ServeLoop(fd, nSlots, ServeCompile);
+}
+
+// Check a Request's Compile Command (Configured Compiler, No Output, Plugin, Wrapper, Tool Directory, Specs or Response File Flags; Why When Rejected)
+bool WorkerAccepts(const VecS& argv, String& why)
+{
+	// Configured Compiler
+	if (argv.empty() || std::find(WorkerCompilers.begin(), WorkerCompilers.end(), argv[0]) == WorkerCompilers.end())
+	{
+		why = "compiler not allowed: " + (argv.empty() ? String("(none)") : argv[0]);
+		return false;
+	}
+
+	return WorkerFlags(VecS(argv.begin() + 1, argv.end()), why);
+}
+
+// Check Compile Flags Against the Worker Allow-List (Flags Naming No Path, Include Directories Under the Worker Root; Why When Rejected)
+bool WorkerFlags(const VecS& args, String& why)
+{
+	// Flags Taking No Value
+	static const char* const plainFlags[] = { "-c", "-w", "-ansi", "-pedantic", "-pedantic-errors", "-pthread", 0 };
+
+	// Code Generation and Language Flags (Exactly These; Others May Name Files or Load Code)
+	static const char* const fFlags[] = {
+		"-fPIC", "-fpic", "-fPIE", "-fpie", "-fno-pic", "-fno-pie", "-flto", "-flto=thin", "-flto=auto", "-fno-lto",
+		"-fexceptions", "-fno-exceptions", "-frtti", "-fno-rtti", "-fpermissive", "-fno-permissive",
+		"-fomit-frame-pointer", "-fno-omit-frame-pointer", "-fstrict-aliasing", "-fno-strict-aliasing",
+		"-ffunction-sections", "-fdata-sections", "-fvisibility-inlines-hidden", "-fno-plt", "-fno-common",
+		"-fstack-protector", "-fstack-protector-strong", "-fstack-protector-all", "-fno-stack-protector",
+		"-ffast-math", "-fno-fast-math", "-fno-math-errno", "-funroll-loops", "-fno-inline", "-fwrapv", "-fno-threadsafe-statics",
+		"-fdiagnostics-color", "-fno-diagnostics-color", "-fsigned-char", "-funsigned-char", "-fopenmp", 0 };
+
+	for (int a = 0; a < args.size(); a++)
+	{
+		const String& arg = args[a];
+		bool allowed = false;
+
+		for (int f = 0; plainFlags[f] && !allowed; f++)
+		{
+			allowed = arg == plainFlags[f];
+		}
+		for (int f = 0; fFlags[f] && !allowed; f++)
+		{
+			allowed = arg == fFlags[f];
+		}
+
+		// Macros (Attached or the Next Argument), Optimization, Standard, Warnings (Not Those Passing Options to Other Tools), Machine and Debug Info
+		if (!allowed && (arg == "-D" || arg == "-U") && a + 1 < args.size())
+		{
+			allowed = true;
+			a++;
+		}
+		else if (!allowed && arg.find('/') == String::npos)
+		{
+			allowed = (StartsWith(arg, "-D") || StartsWith(arg, "-U") || StartsWith(arg, "-O") || StartsWith(arg, "-std=")) && arg.size() > 2;
+			allowed = allowed || (StartsWith(arg, "-W") && arg.size() > 2 && !StartsWith(arg, "-Wa,") && !StartsWith(arg, "-Wl,") && !StartsWith(arg, "-Wp,"));
+			allowed = allowed || (StartsWith(arg, "-m") && arg.size() > 2);
+			allowed = allowed || (StartsWith(arg, "-g") && arg.find('=') == String::npos);
+		}
+
+		// Include Directories Under the Worker Root (Attached or the Next Argument; Resolved, So Links and ".." Can't Leave It)
+		if (!allowed && (StartsWith(arg, "-I") || StartsWith(arg, "-isystem")))
+		{
+			String flag = StartsWith(arg, "-I") ? "-I" : "-isystem";
+			String dir  = arg.substr(flag.size());
+			if (dir.empty() && a + 1 < args.size())
+			{
+				dir = args[++a];
+			}
+
+			String resolved = NormalizePath(AbsPath(dir));
+			allowed = !WorkerRoot.empty() && !dir.empty() && dir[0] == '/' && (resolved == WorkerRoot || StartsWith(resolved, WorkerRoot + "/"));
+		}
+
+		if (!allowed)
+		{
+			why = "flag not allowed: " + arg;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Command Compiling a Preprocessed Source on a Worker (Preprocessor Flags Dropped; Empty When a Worker Would Refuse a Flag)
+String RemoteCompileCmd(const String& compiler, const String& flags)
+{
+	// Flags Only the Preprocessor Uses, Taking a Value Attached or as the Next Argument
+	static const char* const ppFlags[] = { "-include", "-imacros", "-isystem", "-iquote", "-idirafter", "-I", "-D", "-U", 0 };
+
+	VecS args = Split(flags);
+	VecS kept;
+	for (int a = 0; a < args.size(); a++)
+	{
+		bool dropped = false;
+		for (int f = 0; ppFlags[f] && !dropped; f++)
+		{
+			dropped = StartsWith(args[a], ppFlags[f]);
+			a += dropped && args[a] == ppFlags[f] ? 1 : 0;
+		}
+
+		if (!dropped)
+		{
+			kept.push_back(args[a]);
+		}
+	}
+
+	String why;
+	return WorkerFlags(kept, why) ? compiler + " " + Concat(kept) : "";
+}
+
+// Loopback Address (Reachable Only From This Host)
+bool IsLoopback(const String& bindAddr)
+{
+	return bindAddr == "localhost" || bindAddr == "::1" || StartsWith(bindAddr, "127.");
+}
+
+
+////////////////////////////
+// Network Implementation //
+////////////////////////////
+
+// Connect to Host (Timeout in Seconds for Connecting, Sending and Receiving, 0 for None)
+int Connect(const String& host, const String& port, int timeout)
+{
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* addrs = 0;
+	if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs) != 0)
+	{
+		return -1;
+	}
+
+	int fd = -1;
+	for (addrinfo* a = addrs; a; a = a->ai_next)
+	{
+		fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+		if (fd < 0)
+		{
+			continue;
+		}
+
+		// Timeout (Applies to connect() Too)
+		if (timeout > 0)
+		{
+			timeval tv;
+			tv.tv_sec  = timeout;
+			tv.tv_usec = 0;
+			setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+			setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		}
+
+		if (connect(fd, a->ai_addr, a->ai_addrlen) == 0)
+		{
+			break;
+		}
+
+		close(fd);
+		fd = -1;
+	}
+
+	freeaddrinfo(addrs);
+	return fd;
+}
+
+// Listen on Address (Exits When Unable)
+int Listen(const String& bindAddr, const String& port)
+{
+	// Resolve Address
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags    = AI_PASSIVE;
+
+	addrinfo* addrs = 0;
+	if (getaddrinfo(bindAddr.c_str(), port.c_str(), &hints, &addrs) != 0 || !addrs)
+	{
+		std::cerr << "Unable to resolve address: " << bindAddr << ":" << port << std::endl;
+		Abort();
+	}
+
+	// Listen
+	int fd = socket(addrs->ai_family, addrs->ai_socktype, addrs->ai_protocol);
+	int yes = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+	if (fd < 0 || bind(fd, addrs->ai_addr, addrs->ai_addrlen) != 0 || listen(fd, 64) != 0)
+	{
+		std::cerr << "Unable to listen on: " << bindAddr << ":" << port << std::endl;
+		Abort();
+	}
+
+	freeaddrinfo(addrs);
+	return fd;
+}
+
+// Serve Connections, Each in a Forked Child, Up To nSlots at Once
+void ServeLoop(int fd, int nSlots, void (*serve)(int))
+{
+	int alive = 0;
+	while (true)
+	{
+		// At Capacity
+		while (alive >= nSlots && wait(0) > 0)
+		{
+			alive--;
+		}
+
+		// Reap Finished Requests
+		while (alive > 0 && waitpid(-1, 0, WNOHANG) > 0)
+		{
+			alive--;
+		}
+
+		// Next Request
+		int conn = accept(fd, 0, 0);
+		if (conn < 0)
+		{
+			continue;
+		}
+
+		int pid = fork();
+
+		// Child
+		if (pid == 0)
+		{
+			close(fd);
+			serve(conn);
+			close(conn);
+			exit(0);
+		}
+
+		// Parent
+		if (pid > 0)
+		{
+			alive++;
+		}
+
+		close(conn);
+	}
+}
+
+// Send All Data
+bool SendAll(int fd, const String& data)
+{
+	size_t sent = 0;
+	while (sent < data.size())
+	{
+		ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if (n <= 0)
+		{
+			return false;
+		}
+
+		sent += n;
+	}
+
+	return true;
+}
+
+// Receive Line
+bool RecvLine(int fd, String& line)
+{
+	line.clear();
+
+	char c;
+	while (recv(fd, &c, 1, 0) == 1)
+	{
+		if (c == '\n')
+		{
+			return true;
+		}
+
+		line += c;
+	}
+
+	return false;
+}
+
+// Receive Exact Number of Bytes
+bool RecvAll(int fd, String& data, size_t n)
+{
+	data.clear();
+
+	char buffer[65536];
+	while (data.size() < n)
+	{
+		size_t want = n - data.size();
+		if (want > sizeof(buffer))
+		{
+			want = sizeof(buffer);
+		}
+
+		ssize_t r = recv(fd, buffer, want, 0);
+		if (r <= 0)
+		{
+			return false;
+		}
+
+		data.append(buffer, r);
+	}
+
+	return true;
+}
+
+// Parse Message Length (Decimal Digits Only, Surrounding Blanks Allowed; False When Malformed or Above max)
+bool ParseLength(const String& text, size_t max, size_t& length)
+{
+	size_t c = text.find_first_not_of(" \t");
+	size_t end = text.find_last_not_of(" \t\r");
+	if (c == String::npos || end == String::npos)
+	{
+		return false;
+	}
+
+	length = 0;
+	for (; c <= end; c++)
+	{
+		if (!isdigit((unsigned char)text[c]))
+		{
+			return false;
+		}
+
+		size_t digit = text[c] - '0';
+		if (length > (max - digit) / 10)
+		{
+			return false;
+		}
+		length = length * 10 + digit;
+	}
+
+	return true;
+}
+
+// Execute Without Shell (Output to Log File, Returns Exit Code)
+int Exec(const VecS& argv, const String& logFile)
+{
+	int pid = fork();
+
+	// Error
+	if (pid < 0)
+	{
+		return 1;
+	}
+
+	// Child
+	if (pid == 0)
+	{
+		FILE* log = fopen(logFile.c_str(), "w");
+		if (log)
+		{
+			dup2(fileno(log), 1);
+			dup2(fileno(log), 2);
+		}
+
+		std::vector<char*> cargv;
+		for (int a = 0; a < argv.size(); a++)
+		{
+			cargv.push_back(const_cast<char*>(argv[a].c_str()));
+		}
+		cargv.push_back(0);
+
+		execvp(cargv[0], &cargv[0]);
+		_exit(127);
+	}
+
+	// Parent
+	int status;
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+	{
+		return 1;
+	}
+
+	return WEXITSTATUS(status);
+}
+
+
+
+////////////////////////////////
+// Job History Implementation //
+////////////////////////////////
+
+// Hash (64-bit FNV-1a, As Hex)
+String Hash(const String& data)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	char buffer[20];
+	sprintf(buffer, "%016llx", hash);
+	return buffer;
+}
+
+// Current Time (Seconds)
+double Now()
+{
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// Load Job History (One Record Per Line)
+void LoadHistory()
+{
+	std::ifstream stream(Join(StateDir, "JobHistory").c_str());
+
+	JobStats js;
+	while (stream >> js.output >> js.cmdHash >> js.wall >> js.user >> js.sys >> js.maxRss >> js.inBlock >> js.outBlock >> js.when)
+	{
+		History[js.output + " " + js.cmdHash] = js;
+	}
+}
+
+// Save Job History (Written Aside, Then Renamed)
+void SaveHistory()
+{
+	MkDir(StateDir);
+
+	String path = Join(StateDir, "JobHistory");
+	String temp = path + ".tmp";
+
+	std::ofstream stream(temp.c_str());
+	for (MapSJS::iterator h = History.begin(); h != History.end(); ++h)
+	{
+		const JobStats& js = h->second;
+		stream << js.output  << " " << js.cmdHash << " "
+			   << js.wall    << " " << js.user    << " " << js.sys      << " "
+			   << js.maxRss  << " " << js.inBlock << " " << js.outBlock << " "
+			   << js.when    << std::endl;
+	}
+	stream.close();
+
+	rename(temp.c_str(), path.c_str());
+}
+
+// Record Job Statistics (Of a Batch Member, Its share of the Batch)
+void RecordStats(const Job& job, double start, const rusage& usage, double share)
+{
+	JobStats js;
+	js.output   = InDir(job.dir, job.output);
+	js.cmdHash  = Hash(job.cmd);
+	js.wall     = (Now() - start) * share;
+	js.user     = (usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6) * share;
+	js.sys      = (usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6) * share;
+	js.maxRss   = usage.ru_maxrss;
+	js.inBlock  = usage.ru_inblock * share;
+	js.outBlock = usage.ru_oublock * share;
+	js.when     = time(0);
+
+	// Drop Records of Older Commands for This Output
+	String prefix = js.output + " ";
+	MapSJS::iterator h = History.lower_bound(prefix);
+	while (h != History.end() && h->first.compare(0, prefix.size(), prefix) == 0)
+	{
+		History.erase(h++);
+	}
+
+	History[prefix + js.cmdHash] = js;
+	RunStats.push_back(js);
+}
+
+// Record Command of an Output Not Built by This Run (Timings Kept Unless wall is Given)
+void RecordCommand(const String& output, const String& cmdHash, double wall)
+{
+	if (History.count(output + " " + cmdHash))
+	{
+		return;
+	}
+
+	// Timings of the Output's Previous Command
+	const JobStats* previous = FindStats(output, cmdHash);
+	JobStats js = previous ? *previous : JobStats();
+	js.output  = output;
+	js.cmdHash = cmdHash;
+	js.wall    = wall > 0 ? wall : js.wall;
+	js.when    = time(0);
+
+	// Drop Records of Older Commands for This Output
+	String prefix = output + " ";
+	MapSJS::iterator h = History.lower_bound(prefix);
+	while (h != History.end() && h->first.compare(0, prefix.size(), prefix) == 0)
+	{
+		History.erase(h++);
+	}
+
+	History[prefix + cmdHash] = js;
+}
+
+// Find Job Statistics (Exact Command, Else Any Command for Output)
+const JobStats* FindStats(const String& output, const String& cmdHash)
+{
+	MapSJS::iterator exact = History.find(output + " " + cmdHash);
+	if (exact != History.end())
+	{
+		return &exact->second;
+	}
+
+	String prefix = output + " ";
+	MapSJS::iterator h = History.lower_bound(prefix);
+	if (h != History.end() && h->first.compare(0, prefix.size(), prefix) == 0)
+	{
+		return &h->second;
+	}
+
+	return 0;
+}
+
+// Order by Wall Time (Descending)
+bool ByWall(const JobStats& a, const JobStats& b)
+{
+	return a.wall > b.wall;
+}
+
+// Order by Peak Resident Set (Descending)
+bool ByRss(const JobStats& a, const JobStats& b)
+{
+	return a.maxRss > b.maxRss;
+}
+
+// Report Slowest and Largest Jobs
+void ReportJobs(const VecJS& stats, int n)
+{
+	VecJS sorted = stats;
+
+	// Totals
+	double wall = 0;
+	double cpu  = 0;
+	for (VecJS::const_iterator s = stats.begin(); s != stats.end(); ++s)
+	{
+		wall += s->wall;
+		cpu  += s->user + s->sys;
+	}
+
+	char line[256];
+	sprintf(line, "%d jobs, %.2fs wall, %.2fs cpu", (int)stats.size(), wall, cpu);
+	std::cout << Prefix << FgBlu() << "Jobs: " << FgOff() << line << std::endl;
+
+	// Slowest
+	std::sort(sorted.begin(), sorted.end(), ByWall);
+	std::cout << Prefix << FgBlu() << "Slowest Jobs:" << FgOff() << std::endl;
+	for (int i = 0; i < n && i < sorted.size(); i++)
+	{
+		const JobStats& js = sorted[i];
+		sprintf(line, "%9.2fs wall %9.2fs user %8.2fs sys ", js.wall, js.user, js.sys);
+		std::cout << Star() << FgYlw() << line << FgOff() << js.output << std::endl;
+	}
+
+	// Largest
+	std::sort(sorted.begin(), sorted.end(), ByRss);
+	std::cout << Prefix << FgBlu() << "Largest Jobs:" << FgOff() << std::endl;
+	for (int i = 0; i < n && i < sorted.size(); i++)
+	{
+		const JobStats& js = sorted[i];
+		sprintf(line, "%9ld KB rss %8ld in %8ld out ", js.maxRss, js.inBlock, js.outBlock);
+		std::cout << Star() << FgYlw() << line << FgOff() << js.output << std::endl;
+	}
+}
+
+
+// Order by Remaining Critical Path (Descending)
+bool ByRank(const Job& a, const Job& b)
+{
+	return a.rank > b.rank;
+}
+
+// Estimate Job Costs and Order by Remaining Critical Path (Reports Gain Over Naive Order)
+VecJ OrderJobs(const VecJ& jobs, int nSpawn)
+{
+	VecJ result = jobs;
+
+	// Historical Durations, and Seconds-Per-Byte Calibrated Against Them
+	double knownWall  = 0;
+	double knownBytes = 0;
+	double knownRss   = 0;
+	int    knownJobs  = 0;
+	std::vector<bool> known(result.size(), false);
+
+	for (int j = 0; j < result.size(); j++)
+	{
+		const JobStats* js = FindStats(InDir(result[j].dir, result[j].output), Hash(result[j].cmd));
+		if (js)
+		{
+			result[j].cost   = js->wall;
+			result[j].memory = js->maxRss;
+			known[j] = true;
+			knownJobs++;
+			knownRss += js->maxRss;
+
+			long size = GetFileSize(InDir(result[j].dir, result[j].source));
+			if (size > 0)
+			{
+				knownWall  += js->wall;
+				knownBytes += size;
+			}
+		}
+	}
+
+	// Default Rate When Nothing is Known (Roughly 1s per 100KB of Source)
+	double secsPerByte = (knownWall > 0 && knownBytes > 0) ? knownWall / knownBytes : 1e-5;
+
+	// Memory of Jobs Without History (Average of Known Jobs, Else 256MB)
+	long defaultRss = knownJobs > 0 ? (long)(knownRss / knownJobs) : 256 * 1024;
+
+	// Source-Size Heuristic for Jobs Without History
+	for (int j = 0; j < result.size(); j++)
+	{
+		if (!known[j])
+		{
+			result[j].cost   = Max(GetFileSize(InDir(result[j].dir, result[j].source)), 1) * secsPerByte;
+			result[j].memory = defaultRss;
+
+			// Whole-Program Optimization
+			if (result[j].lto)
+			{
+				result[j].cost   *= LtoWeight;
+				result[j].memory *= LtoWeight;
+			}
+		}
+	}
+
+	// Naive Order
+	if (NaiveOrder || result.size() <= 1)
+	{
+		return result;
+	}
+
+	// Remaining Critical Path (Dependents Ranked Before the Jobs They Wait On, in Reverse Topological Order)
+	VecI waiting;
+	std::vector<VecI> dependents;
+	JobGraph(result, waiting, dependents);
+
+	VecI topo;
+	for (int j = 0; j < result.size(); j++)
+	{
+		if (waiting[j] == 0)
+		{
+			topo.push_back(j);
+		}
+	}
+	for (int t = 0; t < topo.size(); t++)
+	{
+		for (VecI::iterator d = dependents[topo[t]].begin(); d != dependents[topo[t]].end(); ++d)
+		{
+			if (--waiting[*d] == 0)
+			{
+				topo.push_back(*d);
+			}
+		}
+	}
+
+	for (int j = 0; j < result.size(); j++)
+	{
+		result[j].rank = result[j].cost;
+	}
+	for (int t = topo.size() - 1; t >= 0; t--)
+	{
+		Job& job = result[topo[t]];
+		for (VecI::iterator d = dependents[topo[t]].begin(); d != dependents[topo[t]].end(); ++d)
+		{
+			job.rank = Max(job.rank, job.cost + result[*d].rank);
+		}
+	}
+
+	double naive = Makespan(result, nSpawn);
+	std::stable_sort(result.begin(), result.end(), ByRank);
+	double ordered = Makespan(result, nSpawn);
+
+	// Report Gain When Order Matters (And Some Durations are Known)
+	if (result.size() > nSpawn && ordered > 0 && knownJobs > 0)
+	{
+		char line[128];
+		sprintf(line, "%d jobs, est. %.2fs (naive order %.2fs, %.2fx)", (int)result.size(), ordered, naive, naive / ordered);
+		std::cout << Prefix << FgBlu() << "Schedule: " << FgOff() << line << std::endl;
+	}
+
+	return result;
+}
+
+// Estimated Makespan of Jobs on nSpawn Slots (Each Started When Its Inputs are Done, Earliest in Order First)
+double Makespan(const VecJ& jobs, int nSpawn)
+{
+	VecI waiting;
+	std::vector<VecI> dependents;
+	JobGraph(jobs, waiting, dependents);
+
+	// Ready Jobs (Min-Heap of Positions) and Running Jobs (Min-Heap of Finish Time, Job)
+	std::greater<int> laterInt;
+	std::greater<std::pair<double, int> > later;
+	VecI ready;
+	std::vector<std::pair<double, int> > running;
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		if (waiting[j] == 0)
+		{
+			ready.push_back(j);
+		}
+	}
+	std::make_heap(ready.begin(), ready.end(), laterInt);
+
+	double now  = 0;
+	int    free = Max(nSpawn, 1);
+	while (true)
+	{
+		// Start Ready Jobs on Free Slots
+		while (free > 0 && !ready.empty())
+		{
+			std::pop_heap(ready.begin(), ready.end(), laterInt);
+			int j = ready.back();
+			ready.pop_back();
+
+			running.push_back(std::make_pair(now + jobs[j].cost, j));
+			std::push_heap(running.begin(), running.end(), later);
+			free--;
+		}
+
+		if (running.empty())
+		{
+			break;
+		}
+
+		// Next Finish (Frees a Slot, Readies Jobs Waiting on It)
+		std::pop_heap(running.begin(), running.end(), later);
+		now = running.back().first;
+		int j = running.back().second;
+		running.pop_back();
+		free++;
+
+		for (VecI::iterator d = dependents[j].begin(); d != dependents[j].end(); ++d)
+		{
+			if (--waiting[*d] == 0)
+			{
+				ready.push_back(*d);
+				std::push_heap(ready.begin(), ready.end(), laterInt);
+			}
+		}
+	}
+
+	return now;
+}
+
+
+
+//////////////////////////////
+// Admission Implementation //
+//////////////////////////////
+
+// Job Fits (The First Job Always Fits)
+bool Admission::Admits(JobKind kind, int count, long memory, bool local) const
+{
+	// Kind Caps
+	if (kind == JobLink && LinkSpawn > 0 && links + count > LinkSpawn)
+	{
+		return false;
+	}
+
+	if (kind == JobCompile && CompileSpawn > 0 && compiles + count > CompileSpawn)
+	{
+		return false;
+	}
+
+	// Memory Budget (Local Jobs Only)
+	if (local && MemBudget > 0 && (used > 0 || count > 1) && used + memory > MemBudget)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+// Account Started Job
+void Admission::Admit(const VecJ& jobs, const VecI& members, bool local)
+{
+	for (VecI::const_iterator m = members.begin(); m != members.end(); ++m)
+	{
+		if (jobs[*m].kind == JobLink)
+		{
+			links++;
+		}
+		else
+		{
+			compiles++;
+		}
+
+		if (local)
+		{
+			used += jobs[*m].memory;
+		}
+	}
+}
+
+// Account Finished Job
+void Admission::Retire(const VecJ& jobs, const VecI& members, bool local)
+{
+	for (VecI::const_iterator m = members.begin(); m != members.end(); ++m)
+	{
+		if (jobs[*m].kind == JobLink)
+		{
+			links--;
+		}
+		else
+		{
+			compiles--;
+		}
+
+		if (local)
+		{
+			used -= jobs[*m].memory;
+		}
+	}
+}
+
+// Read First Number from File (-1 When Missing or Not a Number)
+long ReadNumber(const String& path)
+{
+	std::ifstream stream(path.c_str());
+
+	long long value;
+	if (stream >> value)
+	{
+		return value;
+	}
+
+	return -1;
+}
+
+// Default Memory Budget (Available Memory, Limited by cgroup memory.max)
+long GetMemoryBudget()
+{
+	long budget = 0;
+
+	// Available Memory (KB)
+	std::ifstream meminfo("/proc/meminfo");
+	String key;
+	long value;
+	String unit;
+	while (meminfo >> key >> value >> unit)
+	{
+		if (key == "MemAvailable:")
+		{
+			budget = value;
+			break;
+		}
+	}
+
+	// cgroup v2 Path
+	String cgroup = GetCgroupDir("memory.max");
+
+	// cgroup Limit ("max" When Unlimited)
+	long limit   = ReadNumber(cgroup + "/memory.max");
+	long current = ReadNumber(cgroup + "/memory.current");
+
+	// cgroup v1
+	if (limit < 0)
+	{
+		limit   = ReadNumber("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+		current = ReadNumber("/sys/fs/cgroup/memory/memory.usage_in_bytes");
+	}
+
+	if (limit > 0)
+	{
+		long room = (limit - (current > 0 ? current : 0)) / 1024;
+		if (budget == 0 || room < budget)
+		{
+			budget = room;
+		}
+	}
+
+	return budget;
+}
+
+// cgroup v2 Directory of This Process Having a Control File (The Root When None Does)
+String GetCgroupDir(const String& control)
+{
+	String cgroup = "/sys/fs/cgroup";
+
+	// Path (0::/path)
+	std::ifstream self("/proc/self/cgroup");
+	String line;
+	while (getline(self, line))
+	{
+		if (line.compare(0, 3, "0::") == 0 && FileExists(cgroup + line.substr(3) + "/" + control))
+		{
+			return cgroup + line.substr(3);
+		}
+	}
+
+	return cgroup;
+}
+
+
+
+//////////////////////////////
+// Placement Implementation //
+//////////////////////////////
+
+// Parse CPU List ("0-3,8,10-11")
+VecI ParseCpuList(const String& list)
+{
+	VecI cpus;
+
+	VecS ranges = SplitOn(list, ',');
+	for (VecS::iterator r = ranges.begin(); r != ranges.end(); ++r)
+	{
+		size_t dash = r->find('-');
+		int first = atoi(r->substr(0, dash).c_str());
+		int last  = (dash == String::npos) ? first : atoi(r->substr(dash + 1).c_str());
+
+		for (int c = first; c <= last; c++)
+		{
+			cpus.push_back(c);
+		}
+	}
+
+	return cpus;
+}
+
+// Discover CPU Topology (Usable CPUs by NUMA Node)
+void LoadTopology()
+{
+	CpuNodes.clear();
+
+	// Usable CPUs (Affinity Mask, Narrowed by cpusets and taskset)
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+	if (sched_getaffinity(0, sizeof(mask), &mask) != 0)
+	{
+		return;
+	}
+
+	// Nodes (Only the Usable CPUs of Each)
+	VecS entries = ListFiles("/sys/devices/system/node");
+	std::sort(entries.begin(), entries.end());
+	for (VecS::iterator e = entries.begin(); e != entries.end(); ++e)
+	{
+		if (e->compare(0, 4, "node") != 0 || e->find_first_not_of("0123456789", 4) != String::npos)
+		{
+			continue;
+		}
+
+		std::ifstream stream(("/sys/devices/system/node/" + *e + "/cpulist").c_str());
+		String list;
+		stream >> list;
+
+		VecI usable;
+		VecI cpus = ParseCpuList(list);
+		for (VecI::iterator c = cpus.begin(); c != cpus.end(); ++c)
+		{
+			if (*c < CPU_SETSIZE && CPU_ISSET(*c, &mask))
+			{
+				usable.push_back(*c);
+			}
+		}
+
+		if (!usable.empty())
+		{
+			CpuNodes.push_back(usable);
+		}
+	}
+
+	// No NUMA (One Node of Every Usable CPU)
+	if (CpuNodes.empty())
+	{
+		VecI usable;
+		for (int c = 0; c < CPU_SETSIZE; c++)
+		{
+			if (CPU_ISSET(c, &mask))
+			{
+				usable.push_back(c);
+			}
+		}
+
+		CpuNodes.push_back(usable);
+	}
+}
+
+// CPU Limit (Usable CPUs, Limited by cgroup cpu.max Quota)
+int GetCpuLimit()
+{
+	int limit = 0;
+	for (std::vector<VecI>::iterator n = CpuNodes.begin(); n != CpuNodes.end(); ++n)
+	{
+		limit += n->size();
+	}
+
+	// cgroup v2 Quota ("quota period", Quota "max" When Unlimited)
+	long quota  = -1;
+	long period = -1;
+	std::ifstream stream((GetCgroupDir("cpu.max") + "/cpu.max").c_str());
+	String max;
+	if (stream >> max >> period && max != "max")
+	{
+		quota = atol(max.c_str());
+	}
+
+	// cgroup v1 (-1 When Unlimited)
+	if (!stream)
+	{
+		quota  = ReadNumber("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+		period = ReadNumber("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+	}
+
+	// Whole CPUs of the Quota (Rounded Up, At Least One)
+	if (quota > 0 && period > 0)
+	{
+		int cpus = Max((quota + period - 1) / period, 1);
+		if (limit == 0 || cpus < limit)
+		{
+			limit = cpus;
+		}
+	}
+
+	return Max(limit, 1);
+}
+
+// Place Worker of a Local Slot (Slots Interleaved Across Nodes, Pinned to Its Node or One Core)
+void PlaceWorker(int slot)
+{
+	if (PinMode == "off" || CpuNodes.empty())
+	{
+		return;
+	}
+
+	// Node of the Slot (Consecutive Slots on Different Nodes, So Links Spread Over Their Memory)
+	const VecI& node = CpuNodes[slot % CpuNodes.size()];
+
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+
+	// Core (The Slot's Turn on Its Node)
+	if (PinMode == "core")
+	{
+		CPU_SET(node[(slot / CpuNodes.size()) % node.size()], &mask);
+	}
+	// Whole Node (Scheduled Freely Within It, Memory Allocated Locally)
+	else
+	{
+		for (VecI::const_iterator c = node.begin(); c != node.end(); ++c)
+		{
+			CPU_SET(*c, &mask);
+		}
+	}
+
+	sched_setaffinity(0, sizeof(mask), &mask);
+}
+
+// Lower Priority of the Build (nice Level, and a Best-Effort I/O Priority to Match)
+void LowerPriority(int nice)
+{
+	if (setpriority(PRIO_PROCESS, 0, nice) != 0)
+	{
+		std::cerr << "Unable to set nice level: " << nice << std::endl;
+	}
+
+	// I/O Priority (Best-Effort Class, Level 0-7 From the nice Level as ionice Maps It)
+	int level = std::min(std::max((nice + 20) / 5, 0), 7);
+	if (syscall(SYS_ioprio_set, 1, 0, (2 << 13) | level) != 0)
+	{
+		std::cerr << "Unable to set I/O priority: " << level << std::endl;
+	}
+}
+
+
+
+//////////////////////////////////////
+// Unit-Test Results Implementation //
+//////////////////////////////////////
+
+// Load Unit-Test Results (Binary Followed by Input Hashes, One Line Each)
+void LoadTestResults()
+{
+	std::ifstream stream(Join(StateDir, "TestResults").c_str());
+
+	String line;
+	while (getline(stream, line))
+	{
+		VecS tokens = Split(line);
+		if (tokens.size() >= 2)
+		{
+			TestResults[tokens[0]] = VecS(tokens.begin() + 1, tokens.end());
+		}
+	}
+}
+
+// Save Unit-Test Results (Written Aside, Then Renamed)
+void SaveTestResults()
+{
+	MkDir(StateDir);
+
+	String path = Join(StateDir, "TestResults");
+	String temp = path + ".tmp";
+
+	std::ofstream stream(temp.c_str());
+	for (MapSV::iterator t = TestResults.begin(); t != TestResults.end(); ++t)
+	{
+		stream << t->first << " " << Concat(t->second) << std::endl;
+	}
+	stream.close();
+
+	rename(temp.c_str(), path.c_str());
+}
+
+// Digest of Inputs Shared by a Project's Unit-Tests (Names and Content Hashes, Computed Once per Project)
+String SharedInputsDigest(const SetS& sharedInputs)
+{
+	String digest;
+	for (SetS::const_iterator i = sharedInputs.begin(); i != sharedInputs.end(); ++i)
+	{
+		digest += " " + *i + " " + HashFile(*i);
+	}
+
+	return digest;
+}
+
+// Unit-Test Input Hash (Binary, Include Closure, and the Shared Inputs Digest)
+String TestInputHash(const String& binFile, const VecI& includes, const String& sharedDigest)
+{
+	String inputs = binFile + " " + HashFile(binFile);
+
+	for (VecI::const_iterator i = includes.begin(); i != includes.end(); ++i)
+	{
+		// Token Stream of Fingerprinted Headers, Else Content
+		std::map<String, std::pair<int, String> >::iterator print = HeaderPrints.find(PathStr(*i));
+		inputs += " " + PathStr(*i) + " " + (print != HeaderPrints.end() ? print->second.second : HashFile(PathStr(*i)));
+	}
+
+	return Hash(inputs + sharedDigest);
+}
+
+// Unit-Test Passed With Inputs
+bool TestPassed(const String& binFile, const String& inputHash)
+{
+	MapSV::iterator find = TestResults.find(binFile);
+	if (find == TestResults.end())
+	{
+		return false;
+	}
+
+	return std::find(find->second.begin(), find->second.end(), inputHash) != find->second.end();
+}
+
+// Record Passing Unit-Test
+void RecordTestPass(const String& binFile, const String& inputHash)
+{
+	VecS& hashes = TestResults[binFile];
+
+	// Most Recent Last
+	hashes.erase(std::remove(hashes.begin(), hashes.end(), inputHash), hashes.end());
+	hashes.push_back(inputHash);
+
+	// Keep Most Recent
+	if (hashes.size() > TestResultsKept)
+	{
+		hashes.erase(hashes.begin(), hashes.end() - TestResultsKept);
+	}
+}
+
+
+
+////////////////////////////
+// Explain Implementation //
+////////////////////////////
+
+// Explain Job (When in Explain Mode)
+void Explain(const String& output, const String& reason)
+{
+	Reasons[Qualify(output)] = reason;
+
+	if (ExplainMode)
+	{
+		std::cout << Prefix << FgBlu() << "Explain: " << FgOff() << FgYlw() << output << ": " << FgOff() << reason << std::endl;
+	}
+}
+
+// Reason for Input Newer Than Output (With Both Timestamps)
+String NewerReason(const String& input, const String& output)
+{
+	return "newer input " + input + " (" + FormatTime(GetFileModTm(input)) + " > " + FormatTime(GetFileModTm(output)) + ")";
+}
+
+// Most Recently Modified File
+String NewestFile(const SetS& files)
+{
+	String newest;
+	int newestTm = -1;
+
+	for (SetS::const_iterator f = files.begin(); f != files.end(); ++f)
+	{
+		int modTm = GetFileModTm(*f);
+		if (modTm > newestTm)
+		{
+			newest   = *f;
+			newestTm = modTm;
+		}
+	}
+
+	return newest;
+}
+
+// Most Recently Modified File (Path Ids)
+String NewestFile(const VecI& files)
+{
+	int newest = -1;
+	int newestTm = -1;
+
+	for (VecI::const_iterator f = files.begin(); f != files.end(); ++f)
+	{
+		int modTm = InclModTm(*f);
+		if (modTm > newestTm)
+		{
+			newest   = *f;
+			newestTm = modTm;
+		}
+	}
+
+	return newest < 0 ? "" : PathStr(newest);
+}
+
+// Command Differs From the Last Successful Run
+bool CommandChanged(const String& output, const String& cmd)
+{
+	String cmdHash = Hash(cmd);
+	const JobStats* js = FindStats(Qualify(output), cmdHash);
+	return js && js->cmdHash != cmdHash;
+}
+
+// Format Timestamp
+String FormatTime(int t)
+{
+	time_t tt = t;
+	char buffer[32];
+	strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localtime(&tt));
+	return buffer;
+}
+
+// Impact Row
+struct ImpactRow
+{
+	String header;
+	int    tus;
+	int    bins;
+	double cost;
+};
+
+// Order by Cost, Then Fan-Out (Descending)
+bool ByImpact(const ImpactRow& a, const ImpactRow& b)
+{
+	if (a.cost != b.cost)
+	{
+		return a.cost > b.cost;
+	}
+
+	return a.tus + a.bins > b.tus + b.bins;
+}
+
+// Report Headers by Rebuild Fan-Out, Weighted by Historical Cost
+void ReportImpact(const String& objSrcDir, const String& objBinDir, bool relinkAll, int n)
+{
+	std::map<int, Impact> impacts;
+	VecI includes;
+
+	// Object Sources
+	VecS objSrcFiles = ListFiles(objSrcDir);
+	for (VecS::iterator o = objSrcFiles.begin(); o != objSrcFiles.end(); ++o)
+	{
+		if (!EndsWith(*o, ".cpp"))
+		{
+			continue;
+		}
+
+		String objSrcFile = Join(objSrcDir, *o);
+		const JobStats* js = FindStats(Qualify(Join(objBinDir, ChopEnd(*o, 4) + ".o")), "");
+
+		GetAllIncls(PathId(objSrcFile), includes);
+		for (VecI::iterator i = includes.begin(); i != includes.end(); ++i)
+		{
+			Impact& impact = impacts[*i];
+			impact.tus.insert(objSrcFile);
+			impact.cost += js ? js->wall : 0;
+			impact.lib = true;
+		}
+	}
+
+	// Binaries (Apps and Unit-Tests) With Their Costs
+	std::map<String, double> binCosts;
+
+	VecVecS descs = GetValsM("AppDir");
+	VecVecS unitDescs = GetValsM("UnitTestDir");
+	descs.insert(descs.end(), unitDescs.begin(), unitDescs.end());
+
+	for (VecVecS::iterator d = descs.begin(); d != descs.end(); ++d)
+	{
+		if (d->size() != 3)
+		{
+			continue;
+		}
+
+		VecS srcFiles = ListFiles((*d)[0]);
+		for (VecS::iterator f = srcFiles.begin(); f != srcFiles.end(); ++f)
+		{
+			if (!EndsWith(*f, ".cpp"))
+			{
+				continue;
+			}
+
+			String srcFile = Join((*d)[0], *f);
+			String objFile = Join(GetVal("ObjectBinDir"), FlatName((*d)[0]), ChopEnd(*f, 4) + ".o");
+			String binFile = Join((*d)[2], ChopEnd(*f, 4));
+
+			// Compile and Link
+			const JobStats* cs = FindStats(Qualify(objFile), "");
+			const JobStats* js = FindStats(Qualify(binFile), "");
+			binCosts[binFile] = (cs ? cs->wall : 0) + (js ? js->wall : 0);
+
+			GetAllIncls(PathId(srcFile), includes);
+			for (VecI::iterator i = includes.begin(); i != includes.end(); ++i)
+			{
+				impacts[*i].tus.insert(srcFile);
+				impacts[*i].bins.insert(binFile);
+			}
+		}
+	}
+
+	// Rows
+	std::vector<ImpactRow> rows;
+	for (std::map<int, Impact>::iterator i = impacts.begin(); i != impacts.end(); ++i)
+	{
+		Impact& impact = i->second;
+
+		// Object Library Change Relinks Every Binary (Static Library)
+		if (impact.lib && relinkAll)
+		{
+			for (std::map<String, double>::iterator b = binCosts.begin(); b != binCosts.end(); ++b)
+			{
+				impact.bins.insert(b->first);
+			}
+		}
+
+		for (SetS::iterator b = impact.bins.begin(); b != impact.bins.end(); ++b)
+		{
+			impact.cost += binCosts[*b];
+		}
+
+		ImpactRow row;
+		row.header = PathStr(i->first);
+		row.tus    = impact.tus.size();
+		row.bins   = impact.bins.size();
+		row.cost   = impact.cost;
+		rows.push_back(row);
+	}
+
+	std::sort(rows.begin(), rows.end(), ByImpact);
+
+	// Report
+	std::cout << Prefix << FgBlu() << "Header Impact:" << FgOff() << " (est. rebuild seconds, TUs, binaries)" << std::endl;
+	for (int r = 0; r < n && r < rows.size(); r++)
+	{
+		char line[64];
+		sprintf(line, "%9.2fs %6d TUs %6d bins ", rows[r].cost, rows[r].tus, rows[r].bins);
+		std::cout << Star() << FgYlw() << line << FgOff() << rows[r].header << std::endl;
+	}
+}
+
+
+
+//////////////////////////////////////////
+// Compile Cost Analysis Implementation //
+//////////////////////////////////////////
+
+// Compiler is Clang
+bool IsClang(const String& compiler)
+{
+	return Capture(compiler + " --version 2>/dev/null").find("clang") != String::npos;
+}
+
+// Capture Command Output
+String Capture(const String& cmd)
+{
+	String result;
+
+	FILE* pipe = popen(cmd.c_str(), "r");
+	if (!pipe)
+	{
+		return result;
+	}
+
+	char buffer[4096];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+	{
+		result.append(buffer, n);
+	}
+
+	pclose(pipe);
+	return result;
+}
+
+// Timing Flags for an Object Compile (Clang -ftime-trace, GCC -ftime-report to stderr, Captured in the Timing File)
+String TraceFlags(bool clang)
+{
+	return clang ? " -ftime-trace" : " -ftime-report";
+}
+
+// Timing File of an Object Compile
+String TraceFile(bool clang, const String& objBinFile)
+{
+	// Clang Names Its Trace After the Output, Extension Replaced (The Temporary Has the Same Stem)
+	if (clang)
+	{
+		return ChopEnd(objBinFile, 2) + ".json";
+	}
+
+	return objBinFile + ".ftr";
+}
+
+// Aggregate Clang -ftime-trace Event
+void AddTraceEvent(const String& name, const String& detail, double dur, std::map<String, MapSD>& totals)
+{
+	if (detail.empty())
+	{
+		return;
+	}
+
+	if (name == "Source")
+	{
+		totals["headers"][detail] += dur;
+	}
+	else if (name.compare(0, 11, "Instantiate") == 0)
+	{
+		totals["templates"][detail] += dur;
+	}
+	else if (name == "CodeGen Function" || name == "OptFunction" || name == "ParseFunctionDefinition")
+	{
+		totals["functions"][detail] += dur;
+	}
+}
+
+// Aggregate Clang -ftime-trace Events (Headers, Templates, Functions; Microseconds)
+void ParseTimeTrace(const String& json, std::map<String, MapSD>& totals)
+{
+	// Events are the Objects at Depth 2 ({"traceEvents": [{...}, ...]})
+	int depth = 0;
+	String key;
+	String name;
+	String detail;
+	double dur = 0;
+
+	for (size_t i = 0; i < json.size(); i++)
+	{
+		char c = json[i];
+
+		// String
+		if (c == '"')
+		{
+			String str;
+			for (i++; i < json.size() && json[i] != '"'; i++)
+			{
+				if (json[i] == '\\' && i + 1 < json.size())
+				{
+					i++;
+				}
+				str += json[i];
+			}
+
+			// Key or Value
+			size_t next = json.find_first_not_of(" \t\r\n", i + 1);
+			if (next != String::npos && json[next] == ':')
+			{
+				key = str;
+			}
+			else if (key == "name" && depth == 2)
+			{
+				name = str;
+			}
+			else if (key == "detail")
+			{
+				detail = str;
+			}
+		}
+		// Number
+		else if ((c >= '0' && c <= '9') || c == '-')
+		{
+			size_t end = json.find_first_of(",}] \t\r\n", i);
+			if (key == "dur" && depth == 2)
+			{
+				dur = atof(json.substr(i, end - i).c_str());
+			}
+			i = (end == String::npos ? json.size() : end) - 1;
+		}
+		// Event Start
+		else if (c == '{')
+		{
+			depth++;
+			if (depth == 2)
+			{
+				name.clear();
+				detail.clear();
+				dur = 0;
+			}
+		}
+		// Event End
+		else if (c == '}')
+		{
+			if (depth == 2)
+			{
+				AddTraceEvent(name, detail, dur, totals);
+			}
+			depth--;
+		}
+	}
+}
+
+// Aggregate GCC -ftime-report Phases (Microseconds)
+void ParseTimeReport(const String& text, std::map<String, MapSD>& totals)
+{
+	std::istringstream stream(text);
+
+	String line;
+	while (getline(stream, line))
+	{
+		// name : usr ( pct) sys ( pct) wall ( pct) ggc ( pct)
+		size_t colon = line.find(':');
+		if (colon == String::npos)
+		{
+			continue;
+		}
+
+		VecS names = Split(line.substr(0, colon));
+		String name = Concat(names);
+		if (name.empty() || name == "TOTAL")
+		{
+			continue;
+		}
+
+		// Drop Percentages
+		String values;
+		int paren = 0;
+		for (size_t i = colon + 1; i < line.size(); i++)
+		{
+			if (line[i] == '(') paren++;
+			if (paren == 0) values += line[i];
+			if (line[i] == ')') paren--;
+		}
+
+		VecS tokens = Split(values);
+		if (tokens.size() >= 3 && tokens[2].find_first_not_of("0123456789.") == String::npos)
+		{
+			totals["phases"][name] += atof(tokens[2].c_str()) * 1e6;
+		}
+	}
+}
+
+// Quote String for JSON
+String JsonStr(const String& str)
+{
+	String result = "\"";
+
+	for (size_t i = 0; i < str.size(); i++)
+	{
+		unsigned char c = str[i];
+		if (c == '"' || c == '\\')
+		{
+			result += '\\';
+			result += c;
+		}
+		else if (c < 0x20)
+		{
+			char buffer[8];
+			sprintf(buffer, "\\u%04x", c);
+			result += buffer;
+		}
+		else
+		{
+			result += c;
+		}
+	}
+
+	return result + "\"";
+}
+
+// Ranked Entry
+struct CostRow
+{
+	String name;
+	double value;
+	double extra;
+};
+
+// Order by Value (Descending)
+bool ByValue(const CostRow& a, const CostRow& b)
+{
+	return a.value > b.value;
+}
+
+// Report Compile Costs (Text, and JSON in StateDir)
+void ReportCompileCost(const VecJ& ppJobs, const VecS& traceFiles, int nSpawn, int n)
+{
+	// Preprocess Every TU
+	Spawn(ppJobs, nSpawn);
+
+	// Preprocessed Sizes
+	std::vector<CostRow> tus;
+	double totalBytes = 0;
+	for (VecJ::const_iterator j = ppJobs.begin(); j != ppJobs.end(); ++j)
+	{
+		String ppFile = InDir(j->dir, j->output);
+
+		CostRow row;
+		row.name  = InDir(j->dir, j->source);
+		row.value = GetFileSize(ppFile);
+		row.extra = 0;
+
+		std::ifstream stream(ppFile.c_str());
+		String line;
+		while (getline(stream, line))
+		{
+			row.extra++;
+		}
+
+		unlink(ppFile.c_str());
+		totalBytes += row.value;
+		tus.push_back(row);
+	}
+	std::sort(tus.begin(), tus.end(), ByValue);
+
+	// Compiler Timings (Last Compile of Every Object)
+	std::map<String, MapSD> totals;
+	for (VecS::const_iterator t = traceFiles.begin(); t != traceFiles.end(); ++t)
+	{
+		if (EndsWith(*t, ".json"))
+		{
+			ParseTimeTrace(ReadFile(*t), totals);
+		}
+		else
+		{
+			ParseTimeReport(ReadFile(*t), totals);
+		}
+	}
+
+	// Text
+	char buffer[128];
+	sprintf(buffer, "%d TUs, %.1f MB preprocessed", (int)tus.size(), totalBytes / (1024 * 1024));
+	std::cout << Prefix << FgBlu() << "Compile Cost: " << FgOff() << buffer << std::endl;
+
+	std::cout << Prefix << FgBlu() << "Largest TUs (Preprocessed):" << FgOff() << std::endl;
+	for (int r = 0; r < n && r < tus.size(); r++)
+	{
+		sprintf(buffer, "%12.0f bytes %9.0f lines ", tus[r].value, tus[r].extra);
+		std::cout << Star() << FgYlw() << buffer << FgOff() << tus[r].name << std::endl;
+	}
+
+	// Ranked Categories
+	std::map<String, std::vector<CostRow> > ranked;
+	for (std::map<String, MapSD>::iterator c = totals.begin(); c != totals.end(); ++c)
+	{
+		std::vector<CostRow>& rows = ranked[c->first];
+		for (MapSD::iterator e = c->second.begin(); e != c->second.end(); ++e)
+		{
+			CostRow row;
+			row.name  = e->first;
+			row.value = e->second / 1e6;
+			row.extra = 0;
+			rows.push_back(row);
+		}
+		std::sort(rows.begin(), rows.end(), ByValue);
+
+		std::cout << Prefix << FgBlu() << "Most Expensive " << c->first << ":" << FgOff() << std::endl;
+		for (int r = 0; r < n && r < rows.size(); r++)
+		{
+			sprintf(buffer, "%9.3fs ", rows[r].value);
+			std::cout << Star() << FgYlw() << buffer << FgOff() << rows[r].name << std::endl;
+		}
+	}
+
+	// JSON
+	MkDir(StateDir);
+	String jsonFile = Join(StateDir, "CompileCost.json");
+	std::ofstream json(jsonFile.c_str());
+
+	json << "{" << std::endl << "  \"tus\": [";
+	for (int r = 0; r < tus.size(); r++)
+	{
+		json << (r ? "," : "") << std::endl << "    {\"source\": " << JsonStr(tus[r].name)
+			 << ", \"bytes\": " << (long)tus[r].value << ", \"lines\": " << (long)tus[r].extra << "}";
+	}
+	json << std::endl << "  ]";
+
+	for (std::map<String, std::vector<CostRow> >::iterator c = ranked.begin(); c != ranked.end(); ++c)
+	{
+		json << "," << std::endl << "  " << JsonStr(c->first) << ": [";
+		for (int r = 0; r < c->second.size(); r++)
+		{
+			json << (r ? "," : "") << std::endl << "    {\"name\": " << JsonStr(c->second[r].name)
+				 << ", \"seconds\": " << c->second[r].value << "}";
+		}
+		json << std::endl << "  ]";
+	}
+	json << std::endl << "}" << std::endl;
+
+	std::cout << Prefix << FgBlu() << "Compile Cost: " << FgOff() << "written to " << jsonFile << std::endl;
+}
+
+
+
+///////////////////////////////
+// Path Table Implementation //
+///////////////////////////////
+
+// Arena Block Size
+const size_t PathBlockSize = 64 * 1024;
+
+PathTable::PathTable() : used(PathBlockSize), slots(1024, 0)
+{
+}
+
+PathTable::~PathTable()
+{
+	for (int b = 0; b < blocks.size(); b++)
+	{
+		delete[] blocks[b];
+	}
+}
+
+// Swap Tables
+void PathTable::Swap(PathTable& other)
+{
+	std::swap(used, other.used);
+	blocks.swap(other.blocks);
+	paths.swap(other.paths);
+	hashes.swap(other.hashes);
+	slots.swap(other.slots);
+	modTm.swap(other.modTm);
+	isFile.swap(other.isFile);
+	statGen.swap(other.statGen);
+	incls.swap(other.incls);
+	scanned.swap(other.scanned);
+	mark.swap(other.mark);
+	sameTm.swap(other.sameTm);
+}
+
+// Intern Path (Returns Id)
+int PathTable::Intern(const String& path)
+{
+	// Hash (32-bit FNV-1a)
+	unsigned hash = 2166136261u;
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		hash ^= (unsigned char)path[i];
+		hash *= 16777619u;
+	}
+
+	// Probe
+	size_t mask = slots.size() - 1;
+	size_t slot = hash & mask;
+	while (slots[slot])
+	{
+		int id = slots[slot] - 1;
+		if (hashes[id] == hash && path == paths[id])
+		{
+			return id;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	// Copy Into Arena (Long Paths Get Their Own Block)
+	size_t size = path.size() + 1;
+	char* dest;
+	if (size > PathBlockSize)
+	{
+		dest = new char[size];
+		blocks.insert(blocks.begin(), dest);
+	}
+	else
+	{
+		if (used + size > PathBlockSize)
+		{
+			blocks.push_back(new char[PathBlockSize]);
+			used = 0;
+		}
+		dest = blocks.back() + used;
+		used += size;
+	}
+	memcpy(dest, path.c_str(), size);
+
+	// New Id
+	int id = paths.size();
+	paths.push_back(dest);
+	hashes.push_back(hash);
+	modTm.push_back(0);
+	isFile.push_back(false);
+	statGen.push_back(0);
+	incls.push_back(VecI());
+	scanned.push_back(false);
+	mark.push_back(0);
+	sameTm.push_back(0);
+	slots[slot] = id + 1;
+
+	// Grow Index (Load Below One Half)
+	if (paths.size() * 2 > slots.size())
+	{
+		std::vector<int> grown(slots.size() * 2, 0);
+		size_t growMask = grown.size() - 1;
+		for (int p = 0; p < paths.size(); p++)
+		{
+			size_t s = hashes[p] & growMask;
+			while (grown[s])
+			{
+				s = (s + 1) & growMask;
+			}
+			grown[s] = p + 1;
+		}
+		slots.swap(grown);
+	}
+
+	return id;
+}
+
+// Path Id (Interned)
+int PathId(const String& path)
+{
+	return Paths.Intern(Qualify(path));
+}
+
+// Path of Id
+String PathStr(int id)
+{
+	return Paths.Path(id);
+}
+
+// Stat Path (Cached Until the Generation Changes)
+void StatPath(int id)
+{
+	if (Paths.statGen[id] == StatGeneration)
+	{
+		StatHits++;
+		return;
+	}
+	StatMisses++;
+
+	struct stat s;
+	bool isFile = stat(Paths.Path(id), &s) == 0 && (s.st_mode & S_IFREG);
+
+	Paths.isFile[id]  = isFile;
+	Paths.modTm[id]   = isFile ? s.st_mtime : 0;
+	Paths.statGen[id] = StatGeneration;
+}
+
+// Forget Cached Stats (Files Were Written)
+void InvalidateStats()
+{
+	StatGeneration++;
+}
+
+
+
+////////////////////////////
+// Project Implementation //
+////////////////////////////
+
+// Path in Directory (Unchanged When Absolute or the Directory is Empty)
+String InDir(const String& dir, const String& path)
+{
+	if (dir.empty() || path.empty() || path[0] == '/')
+	{
+		return path;
+	}
+
+	return NormalizePath(Join(dir, path));
+}
+
+// Path in Current Project Directory
+String Qualify(const String& path)
+{
+	return InDir(ProjectDir, path);
+}
+
+// Normalize Path (Collapse "." and "..")
+String NormalizePath(const String& path)
+{
+	bool absolute = !path.empty() && path[0] == '/';
+
+	VecS parts;
+	VecS tokens = SplitOn(path, '/');
+	for (VecS::iterator t = tokens.begin(); t != tokens.end(); ++t)
+	{
+		if (*t == ".")
+		{
+			continue;
+		}
+
+		if (*t == ".." && !parts.empty() && parts.back() != "..")
+		{
+			parts.pop_back();
+		}
+		else if (*t != ".." || !absolute)
+		{
+			parts.push_back(*t);
+		}
+	}
+
+	String result = absolute ? "/" : "";
+	for (int p = 0; p < parts.size(); p++)
+	{
+		result += (p ? "/" : "") + parts[p];
+	}
+
+	return result.empty() ? "." : result;
+}
+
+// Load Recipe (Lines With Variables Substituted)
+void LoadRecipe(const String& recipe, VecVecS& recipeLines, MapSV& recipeVars)
+{
+	// Open Recipe
+	std::ifstream file(recipe.c_str());
+	if (!file)
+	{
+		std::cerr << "Can't open recipe: " << recipe << std::endl;
+		Abort();
+	}
+
+	// Store Lines
+	VecVecS stored;
+	String line;
+	while (getline(file, line))
+	{
+		// Skip Blanks and Comments
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+
+		// Tokens
+		VecS tokens = Split(line);
+
+		if (!tokens.empty())
+		{
+			// Defines
+			if (tokens[0] == "Define")
+			{
+				// Sufficient Tokens
+				if (tokens.size() >= 2)
+				{
+					// Store Variable
+					for (int t = 2; t < tokens.size(); t++)
+					{
+						recipeVars[tokens[1]].push_back(tokens[t]);
+					}
+				}
+			}
+			// Normal Line
+			else
+			{
+				stored.push_back(tokens);
+			}
+		}
+	}
+
+	// Substitute Variables
+	recipeLines.clear();
+
+	// For Each Line
+	for (int i = 0; i < stored.size(); i++)
+	{
+		// Replaced Tokens
+		VecS repTokens;
+
+		const VecS& tokens = stored[i];
+		for (int t = 0; t < tokens.size(); t++)
+		{
+			// Check For Variable
+			const String& token = tokens[t];
+			if (!token.empty() && token[0] == '$')
+			{
+				// Replace Token With Value
+				MapSV::iterator find = recipeVars.find(token.substr(1));
+				if (find != recipeVars.end())
+				{
+					repTokens.insert(repTokens.end(), find->second.begin(), find->second.end());
+				}
+			}
+			else
+			{
+				// Store Token
+				repTokens.push_back(token);
+			}
+		}
+
+		// Add Line
+		recipeLines.push_back(repTokens);
+	}
+}
+
+// Load Project (Recipe, Name and Include Directories)
+void LoadProject(Project& project)
+{
+	LoadRecipe(project.recipe, project.lines, project.variables);
+
+	lines = project.lines;
+	project.prefix   = FgSky() + "* Bake: " + FgOff() + FgOrg() + GetVal("Name") + FgOff() + " ";
+	project.inclDirs = GetVals("IncludeDirs");
+}
+
+// Visit Project and Its Dependencies (Depth First, 1 While Visiting, 2 When Done)
+void VisitProject(int p, const VecP& loaded, const std::vector<VecI>& deps, VecI& state, VecI& order)
+{
+	if (state[p] == 2)
+	{
+		return;
+	}
+
+	if (state[p] == 1)
+	{
+		std::cerr << "Dependency cycle in workspace at project: " << loaded[p].name << std::endl;
+		Abort();
+	}
+
+	state[p] = 1;
+	for (VecI::const_iterator d = deps[p].begin(); d != deps[p].end(); ++d)
+	{
+		VisitProject(*d, loaded, deps, state, order);
+	}
+	state[p] = 2;
+
+	order.push_back(p);
+}
+
+// Load Workspace (Projects in Dependency Order, State Shared)
+void LoadWorkspace(const String& workspace, VecP& projects)
+{
+	// Workspace Lines (Read With the Recipe Helpers)
+	LoadRecipe(workspace, lines, variables);
+
+	// Workspace Directory (Project Paths are Relative to It)
+	String root = AbsPath(GetDir(workspace));
+
+	Prefix   = FgSky() + "* Bake: " + FgOff() + FgOrg() + GetValOr("Name", workspace) + FgOff() + " ";
+	StateDir = InDir(root, GetValOr("StateDir", StateDir));
+	FingerprintMode = GetValOr("HeaderFingerprints", "off") == "on";
+
+	// Projects (name path/Recipe.cfg)
+	VecP loaded;
+	std::map<String, int> byName;
+
+	VecVecS projDescs = GetValsM("Project");
+	for (VecVecS::iterator d = projDescs.begin(); d != projDescs.end(); ++d)
+	{
+		// Validate Description
+		if (d->size() != 2 || byName.count((*d)[0]))
+		{
+			std::cerr << "Bad format in Workspace for Project, must be of the form 'name path/Recipe.cfg' with a unique name not " << Concat(*d) << std::endl;
+			Abort();
+		}
+
+		Project project;
+		project.name   = (*d)[0];
+		project.recipe = InDir(root, (*d)[1]);
+		project.dir    = GetDir(project.recipe);
+
+		byName[project.name] = loaded.size();
+		loaded.push_back(project);
+	}
+
+	if (loaded.empty())
+	{
+		std::cerr << "No projects in workspace: " << workspace << std::endl;
+		Abort();
+	}
+
+	// Dependencies (name => dep ...)
+	std::vector<VecI> deps(loaded.size());
+
+	VecVecS depDescs = GetValsM("Depends");
+	for (VecVecS::iterator d = depDescs.begin(); d != depDescs.end(); ++d)
+	{
+		// Validate Description
+		bool valid = d->size() >= 3 && (*d)[1] == "=>";
+		for (int t = 0; valid && t < d->size(); t++)
+		{
+			valid = t == 1 || byName.count((*d)[t]);
+		}
+
+		if (!valid)
+		{
+			std::cerr << "Bad format in Workspace for Depends, must be of the form 'name => dep ...' of known projects not " << Concat(*d) << std::endl;
+			Abort();
+		}
+
+		for (int t = 2; t < d->size(); t++)
+		{
+			deps[byName[(*d)[0]]].push_back(byName[(*d)[t]]);
+		}
+	}
+
+	// Dependency Order
+	VecI state(loaded.size(), 0);
+	VecI order;
+	for (int p = 0; p < loaded.size(); p++)
+	{
+		VisitProject(p, loaded, deps, state, order);
+	}
+
+	// Projects in Order (Dependencies Renumbered)
+	VecI position(loaded.size());
+	for (int o = 0; o < order.size(); o++)
+	{
+		position[order[o]] = o;
+	}
+
+	for (int o = 0; o < order.size(); o++)
+	{
+		Project project = loaded[order[o]];
+		for (VecI::iterator d = deps[order[o]].begin(); d != deps[order[o]].end(); ++d)
+		{
+			project.deps.push_back(position[*d]);
+		}
+
+		LoadProject(project);
+		projects.push_back(project);
+	}
+}
+
+// Make Project Current (Recipe, Directory, Include Resolution)
+void UseProject(Project& project)
+{
+	lines      = project.lines;
+	variables  = project.variables;
+	inclDirs   = project.inclDirs;
+	Prefix     = project.prefix;
+	ProjectDir = project.dir;
+
+	// Project Directory (Recipe Paths are Relative to It)
+	if (!project.dir.empty() && chdir(project.dir.c_str()) != 0)
+	{
+		std::cerr << "Can't enter project directory: " << project.dir << std::endl;
+		Abort();
+	}
+
+	// Include Resolution (By Include Directories)
+	String key;
+	for (VecS::iterator i = inclDirs.begin(); i != inclDirs.end(); ++i)
+	{
+		key += " " + Qualify(*i);
+	}
+	UseInclContext(key);
+}
+
+// Use Include Resolution of a Set of Include Directories (Shared Between Projects)
+void UseInclContext(const String& key)
+{
+	if (key == InclContextKey)
+	{
+		return;
+	}
+
+	// Set Current Aside
+	InclContext& current = InclContexts[InclContextKey];
+	current.incls.swap(Paths.incls);
+	current.scanned.swap(Paths.scanned);
+	current.resolved.swap(InclResolved);
+
+	// Take Next (Paths Interned Meanwhile are Unscanned)
+	InclContext& next = InclContexts[key];
+	Paths.incls.swap(next.incls);
+	Paths.scanned.swap(next.scanned);
+	InclResolved.swap(next.resolved);
+
+	Paths.incls.resize(Paths.Size());
+	Paths.scanned.resize(Paths.Size(), false);
+
+	InclContextKey = key;
+}
+
+// Commands Removing Project Outputs
+VecS CleanCommands()
+{
+	VecS cmds;
+
+	// Remove Directories
+	String dirsForRemoval;
+	dirsForRemoval += " " + GetVal("ObjectBinDir");
+
+	VecVecS appDescs = GetValsM("AppDir");
+
+	// For Each Application Description
+	for (VecVecS::iterator a = appDescs.begin(); a != appDescs.end(); ++a)
+	{
+		// Application Description
+		const VecS& appDesc = *a;
+
+		// Validate Description
+		if (appDesc.size() != 3 || appDesc[1] != "=>")
+		{
+			std::cerr << "Bad format in Recipe for AppDir, must be of the form 'appDir => binDir' not " << Concat(appDesc) << std::endl;
+			Abort();
+		}
+
+		// Application Bin Directories
+		String pAppBinDir = appDesc[2];
+		dirsForRemoval += " " + pAppBinDir;
+	}
+
+
+	// Unit-Test Descriptions
+	VecVecS unitDescs = GetValsM("UnitTestDir");
+
+	// For Each Unit-Test Description
+	for (VecVecS::iterator u = unitDescs.begin(); u != unitDescs.end(); ++u)
+	{
+		// Unit-Test Description
+		const VecS& unitDesc = *u;
+
+		// Validate Description
+		if (unitDesc.size() != 3 || unitDesc[1] != "=>")
+		{
+			std::cerr << "Bad format in Recipe for UnitTestDir, must be of the form 'unitDir => binDir' not " << Concat(unitDesc) << std::endl;
+			Abort();
+		}
+
+		// Unit-Test Directories
+		String pUnitBinDir = unitDesc[2];
+		dirsForRemoval += " " + pUnitBinDir;
+	}
+
+	cmds.push_back("rm -rf " + dirsForRemoval);
+	cmds.push_back("rm -f " + GetVal("UnitTestScript"));
+	cmds.push_back("rm -f " + GetVal("ObjectLibArc"));
+
+	// Shared Object Library (Built, or Left From Before the Type Changed)
+	String pObjLibSo = SharedLibName(GetVal("ObjectLibArc"));
+	if (FileExists(pObjLibSo) || GetValOr("ObjectLibType", "static") == "shared")
+	{
+		cmds.push_back("rm -f " + pObjLibSo);
+	}
+
+	return cmds;
+}
+
+// Remove Project Outputs
+void CleanProject()
+{
+	VecS cmds = CleanCommands();
+	for (VecS::iterator c = cmds.begin(); c != cmds.end(); ++c)
+	{
+		std::cout << Star() << "Executing: " << *c << std::endl;
+		system(c->c_str());
+	}
+}
+
+// Resolve Project Settings (LTO Parallelism From nSpawn)
+void ConfigureProject(Project& project, int nSpawn)
+{
+	//////////////
+	// Includes //
+	//////////////
+
+	// Include Flags
+	for (VecS::iterator i = inclDirs.begin(); i != inclDirs.end(); ++i)
+	{
+		project.includeFlags += " -I" + *i;
+	}
+
+	// Library Directories
+	VecS libDirs = GetVals("LibraryDirs");
+
+	// Libraries
+	VecS libraries = GetVals("Libraries");
+
+	// Library Filenames (For Dependencies)
+	project.libFileNames = GetLibFiles();
+
+	// Add Library Paths
+	for (VecS::iterator l = libDirs.begin(); l != libDirs.end(); ++l)
+	{
+		project.libraryFlags += " -L" + *l;
+	}
+
+	// Add Libraries
+	for (VecS::iterator l = libraries.begin(); l != libraries.end(); ++l)
+	{
+		project.libraryFlags += " -l" + *l;
+	}
+
+	// Compiler
+	project.compiler      = GetVal("Compiler");
+	project.compPreFlags  = Concat(GetVals("CompPreFlags"));
+	project.compPostFlags = Concat(GetVals("CompPostFlags"));
+
+	// Object Library Type (static or shared)
+	String objLibType    = GetValOr("ObjectLibType", "static");
+	project.objLibShared = (objLibType == "shared");
+	if (objLibType != "static" && !project.objLibShared)
+	{
+		std::cerr << "Bad value in Recipe for ObjectLibType, must be 'static' or 'shared' not " << objLibType << std::endl;
+		Abort();
+	}
+
+	// Unit-Test Mode (binaries, or runner: Every Unit-Test of a Directory Linked Into One Binary, So Non-Static Symbols Defined in More Than One Unit-Test Collide at Link Time)
+	String unitTestMode = GetValOr("UnitTestMode", "binaries");
+	project.unitRunner  = (unitTestMode == "runner");
+	if (unitTestMode != "binaries" && !project.unitRunner)
+	{
+		std::cerr << "Bad value in Recipe for UnitTestMode, must be 'binaries' or 'runner' not " << unitTestMode << std::endl;
+		Abort();
+	}
+
+	////////////////////////////
+	// Link-Time Optimization //
+	////////////////////////////
+
+	String lto   = HasOpt("lto") ? GetOpt("lto") : GetValOr("LTO", "off");
+	bool   clang = IsClang(project.compiler);
+	if (lto != "off" && lto != "full" && lto != "thin")
+	{
+		std::cerr << "Bad value in Recipe for LTO, must be 'off', 'full' or 'thin' not " << lto << std::endl;
+		Abort();
+	}
+
+	if (lto == "thin" && !clang)
+	{
+		std::cerr << "Bad value in Recipe for LTO, 'thin' needs a clang Compiler not " << project.compiler << std::endl;
+		Abort();
+	}
+
+	// ThinLTO (Parallel Backends, Cache of Unchanged Modules Under ObjectBinDir)
+	if (lto == "thin")
+	{
+		String cacheDir = Join(GetVal("ObjectBinDir"), "thinlto-cache");
+		MkDir(cacheDir);
+
+		char jobs[32];
+		sprintf(jobs, "%d", nSpawn);
+
+		project.ltoCompFlags = " -flto=thin";
+		project.ltoLinkFlags = " -flto=thin -Wl,--thinlto-jobs=" + String(jobs) + " -Wl,--thinlto-cache-dir=" + AbsPath(cacheDir);
+	}
+	// Full LTO (GCC Partitions Share the Job Server, Clang Links Serially)
+	else if (lto == "full")
+	{
+		project.ltoCompFlags = " -flto";
+		project.ltoLinkFlags = clang ? " -flto" : " -flto=jobserver";
+	}
+
+	// Archiver (LTO Objects Need the Plugin-Aware One)
+	project.archiver = GetValOr("Archiver", lto == "off" ? "ar" : (clang ? "llvm-ar" : "gcc-ar"));
+
+	/////////////////
+	// Split DWARF //
+	/////////////////
+
+	String splitDwarf = HasOpt("split-dwarf") ? GetOpt("split-dwarf") : GetValOr("SplitDwarf", "off");
+	if (splitDwarf != "off" && splitDwarf != "on" && splitDwarf != "package")
+	{
+		std::cerr << "Bad value in Recipe for SplitDwarf, must be 'off', 'on' or 'package' not " << splitDwarf << std::endl;
+		Abort();
+	}
+
+	if (splitDwarf != "off" && lto != "off")
+	{
+		std::cerr << "Bad value in Recipe for SplitDwarf, '" << splitDwarf << "' needs LTO off (LTO objects get their debug info at the link)" << std::endl;
+		Abort();
+	}
+
+	// Debug Info in .dwo Files Beside the Objects (Level From the Recipe's -g Flags, Else -g)
+	if (splitDwarf != "off")
+	{
+		bool debug = false;
+		VecS flags = Split(project.compPreFlags + " " + project.compPostFlags);
+		for (VecS::iterator f = flags.begin(); f != flags.end(); ++f)
+		{
+			debug = debug || (f->compare(0, 2, "-g") == 0 && *f != "-gsplit-dwarf");
+		}
+
+		project.dwarfFlags = String(debug ? "" : " -g") + " -gsplit-dwarf";
+	}
+
+	// Package Each Binary's .dwo Files Into binary.dwp (GNU dwp Can't Read the DWARF 5 of Newer GCCs)
+	if (splitDwarf == "package")
+	{
+		project.dwp = GetValOr("Dwp", "llvm-dwp");
+	}
+
+	/////////////
+	// Modules //
+	/////////////
+
+	String modules  = GetValOr("Modules", "off");
+	project.modules = (modules == "on");
+	if (modules != "off" && !project.modules)
+	{
+		std::cerr << "Bad value in Recipe for Modules, must be 'on' or 'off' not " << modules << std::endl;
+		Abort();
+	}
+
+	if (project.modules && clang)
+	{
+		std::cerr << "Bad value in Recipe for Modules, 'on' needs a GCC Compiler (-fmodules-ts) not " << project.compiler << std::endl;
+		Abort();
+	}
+
+	// BMIs Under ObjectBinDir per Flag Set, Found Through a Module Mapper
+	if (project.modules)
+	{
+		String flagSet      = project.compiler + " " + project.compPreFlags + " " + project.compPostFlags + project.ltoCompFlags;
+		project.bmiDir      = Join(GetVal("ObjectBinDir"), "bmi-" + Hash(flagSet).substr(0, 8));
+		project.moduleFlags = " -fmodules-ts -fmodule-mapper=" + Join(project.bmiDir, "mapper");
+		MkDir(project.bmiDir);
+	}
+
+	//////////////////////
+	// Compile Batching //
+	//////////////////////
+
+	project.batch = atoi((HasOpt("batch") ? GetOpt("batch") : GetValOr("CompileBatch", "1")).c_str());
+	if (project.batch < 1)
+	{
+		std::cerr << "Bad value in Recipe for CompileBatch, must be a number of objects of at least 1 not " << GetValOr("CompileBatch", "") << std::endl;
+		Abort();
+	}
+
+	// Batches Compile in the Object Directory (Objects are Named After Their Sources), So Include Directories are Absolute
+	for (VecS::iterator i = inclDirs.begin(); i != inclDirs.end(); ++i)
+	{
+		project.batchInclFlags += " -I" + AbsPath(*i);
+	}
+
+	// Likewise Paths in Recipe Flags; Not Batched When Some Can't Be Made Absolute
+	bool absPre  = AbsFlags(project.compPreFlags, project.batchPreFlags);
+	bool absPost = AbsFlags(project.compPostFlags, project.batchPostFlags);
+	if (project.batch > 1 && !(absPre && absPost))
+	{
+		std::cerr << "Compile flags name relative paths, not batching: " << project.compPreFlags << " " << project.compPostFlags << std::endl;
+		project.batch = 1;
+	}
+
+	////////////////////
+	// Object Library //
+	////////////////////
+
+	project.objSrcDir = GetVal("ObjectSrcDir");
+	project.objBinDir = GetVal("ObjectBinDir");
+	project.objLibArc = GetVal("ObjectLibArc");
+	project.objLibSo  = SharedLibName(project.objLibArc);
+	MkDir(project.objBinDir);
+
+	// Object Library Type Stamp (Apps and Unit-Tests Relink When It Changes)
+	project.objLibStamp = Join(project.objBinDir, "ObjectLibType");
+	UpdateStamp(project.objLibStamp, objLibType);
+
+	// Object Library (Archive or Shared Object)
+	project.objLib = project.objLibShared ? project.objLibSo : project.objLibArc;
+
+	// Position-Independent Objects (Kept Apart from Static Objects)
+	if (project.objLibShared)
+	{
+		project.objBinDir = Join(project.objBinDir, "pic");
+		MkDir(project.objBinDir);
+	}
+
+	// Shared Object Library
+	if (project.objLibShared)
+	{
+		// Runtime Search Path
+		MkDir(GetDir(project.objLibSo));
+		project.libraryFlags += " -Wl,-rpath," + AbsPath(GetDir(project.objLibSo));
+
+		// Object Library Changes Don't Force Relinks
+		project.libFileNames.erase(project.objLibArc);
+		project.libFileNames.erase(project.objLibSo);
+	}
+}
+
+// Collect Object and Object Library Jobs
+void CollectObjects(Project& project, VecJ& jobs, VecJ& ppJobs, VecS& traceFiles)
+{
+	First display;
+
+	// Objects
+	SetS objects;
+
+	// Objects Being Rebuilt (Qualified Outputs) and the First of Them
+	VecS rebuilt;
+	String firstRebuilt;
+
+	// Clang Time-Trace or GCC Time-Report
+	bool clang = (AnalyzeMode == "trace") && IsClang(project.compiler);
+
+	// Object Source Files (Module Interfaces First)
+	VecS objSrcFiles = ListFiles(project.objSrcDir);
+	if (project.modules)
+	{
+		objSrcFiles = ScanModules(project, objSrcFiles);
+	}
+
+	// For Each Object Source File
+	for (VecS::iterator o = objSrcFiles.begin(); o != objSrcFiles.end(); ++o)
+	{
+		// Object Source File
+		const String& objSrcName = *o;
+
+		// Confirm ".cpp"
+		if (!EndsWith(objSrcName, ".cpp"))
+		{
+			continue;
+		}
+
+		String objSrcFile = Join(project.objSrcDir, objSrcName);
+
+		// Source Exists
+		if (!FileExists(objSrcFile))
+		{
+			continue;
+		}
+
+		// Object File
+		String objBinFile = Join(project.objBinDir, ChopEnd(objSrcName, 4) + ".o");
+
+		// Add To Objects
+		objects.insert(objBinFile);
+
+		// Position-Independent Code
+		String picFlag = project.objLibShared ? " -fPIC" : "";
+
+		// Module Unit (Flags, Interfaces Waited For, Why It Rebuilds)
+		String moduleFlags;
+		VecS   moduleAfter;
+		String moduleReason;
+		bool   moduleUnit = ModuleDeps(project, objSrcFile, objBinFile, moduleFlags, moduleAfter, moduleReason);
+
+		// Build Command
+		String cmd = project.compiler;
+		cmd += " "    + project.compPreFlags;
+		cmd += " -c " + objSrcFile;
+		cmd += " -o " + objBinFile;
+		cmd += " "    + project.includeFlags;
+		cmd += " "    + project.compPostFlags;
+		cmd += picFlag;
+		cmd += project.ltoCompFlags;
+		cmd += project.dwarfFlags;
+		cmd += moduleFlags;
+
+		// Preprocess Command
+		String ppFile = objBinFile + ".ii";
+		String ppCmd  = project.compiler;
+		ppCmd += " "    + project.compPreFlags;
+		ppCmd += " -E " + objSrcFile;
+		ppCmd += " -o " + ppFile;
+		ppCmd += " "    + project.includeFlags;
+		ppCmd += " "    + project.compPostFlags;
+		ppCmd += picFlag;
+
+		// Compile Analysis (Preprocessed Size and Compiler Timings; Not of Module Units, They Need BMIs)
+		if (!AnalyzeMode.empty() && !moduleUnit)
+		{
+			Job ppJob(ppCmd, ppFile, objSrcFile, JobCompile);
+			ppJob.dir    = project.dir;
+			ppJob.record = false;
+			ppJobs.push_back(ppJob);
+
+			if (AnalyzeMode == "trace")
+			{
+				traceFiles.push_back(Qualify(TraceFile(clang, objBinFile)));
+			}
+		}
+
+		// Selected by a Target (Itself, Its Source or an Include)
+		if (!Targets.empty())
+		{
+			VecI includes;
+			if (IncludeTargets)
+			{
+				GetAllIncls(PathId(objSrcFile), includes);
+			}
+
+			if (Targeted("", objBinFile, objSrcFile, includes))
+			{
+				Selected.insert(PathId(objBinFile));
+				project.libSelected = true;
+			}
+		}
+
+		// Need-To-Build (And Why)
+		bool needToBuild = false;
+		String reason;
+		OutputsChecked++;
+
+		// Object Doesn't Exist
+		if (Missing(objBinFile))
+		{
+			needToBuild = true;
+			reason = "missing output";
+		}
+		// Split Debug Info Doesn't Exist
+		else if (!project.dwarfFlags.empty() && !FileExists(DwoFile(objBinFile)))
+		{
+			needToBuild = true;
+			reason = "missing output " + DwoFile(objBinFile);
+		}
+		// Object Exists
+		else
+		{
+			// Object Modification Time
+			int objModTime = GetFileModTm(objBinFile);
+
+			// Source File Modified
+			if (GetFileModTm(objSrcFile) > objModTime)
+			{
+				needToBuild = true;
+				reason = NewerReason(objSrcFile, objBinFile);
+			}
+			// Check Includes
+			else
+			{
+				// Includes
+				VecI includes;
+				GetAllIncls(PathId(objSrcFile), includes);
+
+				if (GetFileModTm(includes) > objModTime)
+				{
+					needToBuild = true;
+					reason = NewerReason(NewestFile(includes), objBinFile);
+				}
+				// Command Changed
+				else if (CommandChanged(objBinFile, cmd))
+				{
+					needToBuild = true;
+					reason = "command changed";
+				}
+			}
+		}
+
+		// Imported or Own BMI
+		if (!needToBuild && !moduleReason.empty())
+		{
+			needToBuild = true;
+			reason = moduleReason;
+		}
+
+		// Need To Build
+		if (needToBuild)
+		{
+			Job job(cmd, objBinFile, objSrcFile, JobCompile);
+			job.dir   = project.dir;
+			job.after = QualifiedIds(moduleAfter);
+
+			// Remote-Capable (Preprocessed Locally, Compiled Remotely; Not Module Units, They Need BMIs, Nor Split Debug Info, Its .dwo Stays Remote, Nor Flags Workers Refuse)
+			String ccCmd = RemoteCompileCmd(project.compiler, project.compPreFlags + " " + project.compPostFlags + picFlag + project.ltoCompFlags);
+			if (!moduleUnit && project.dwarfFlags.empty() && !ccCmd.empty())
+			{
+				job.ppFile = ppFile;
+				job.ppCmd  = ppCmd;
+				job.ccCmd  = ccCmd;
+			}
+
+			// Interface Rebuilt (Its Importers Are Too)
+			if (moduleUnit && GetModuleUnit(PathId(objSrcFile)).interface)
+			{
+				project.rebuiltModules.insert(GetModuleUnit(PathId(objSrcFile)).name);
+			}
+
+			// Compiler Timings
+			if (AnalyzeMode == "trace")
+			{
+				job.extra   = TraceFlags(clang);
+				job.errFile = clang ? "" : TraceFile(clang, objBinFile);
+			}
+
+			// Cacheable (Not Module Units, Nor With Split Debug Info or Compiler Timings, Files Beside the Object)
+			if (Cache && !moduleUnit && project.dwarfFlags.empty() && job.extra.empty())
+			{
+				VecI includes;
+				GetAllIncls(PathId(objSrcFile), includes);
+				CacheJob(job, project.compiler, VecS(1, objSrcFile), includes);
+			}
+
+			// Batchable (Likewise; Flags Ahead of the Sources Appended)
+			if (project.batch > 1 && !moduleUnit && project.dwarfFlags.empty() && job.extra.empty())
+			{
+				job.batchCmd  = "cd " + AbsPath(GetDir(objBinFile)) + " && " + project.compiler;
+				job.batchCmd += project.batchPreFlags;
+				job.batchCmd += project.batchInclFlags;
+				job.batchCmd += project.batchPostFlags;
+				job.batchCmd += picFlag;
+				job.batchCmd += project.ltoCompFlags;
+				job.batchCmd += " -c";
+				job.batchMax  = project.batch;
+			}
+
+			jobs.push_back(job);
+			rebuilt.push_back(Qualify(objBinFile));
+			firstRebuilt = rebuilt.size() == 1 ? objBinFile : firstRebuilt;
+
+			// Display
+			if (display) Display("Building", "Objects", project.objSrcDir);
+
+			// Explain
+			Explain(objBinFile, reason);
+		}
+	}
+
+	// Object Library Selected (Itself or One of Its Objects)
+	if (Targeted("", project.objLib, "", VecI()) || project.libSelected)
+	{
+		Selected.insert(PathId(project.objLib));
+		project.libSelected = true;
+	}
+
+	// Build Object Library (Static Archive or Shared Object, After Its Objects; Rebuilt Objects Alone Allow an Early Cutoff)
+	String reason;
+	bool   cutoff = false;
+	OutputsChecked++;
+	if (Missing(project.objLib))
+	{
+		reason = "missing output";
+	}
+	else if (!rebuilt.empty())
+	{
+		reason = "rebuilt input " + firstRebuilt;
+		cutoff = GetFileModTm(objects) <= GetFileModTm(project.objLib);
+	}
+	else if (GetFileModTm(objects) > GetFileModTm(project.objLib))
+	{
+		reason = NewerReason(NewestFile(objects), project.objLib);
+	}
+
+	if (!reason.empty())
+	{
+		// Explain
+		Explain(project.objLib, reason);
+
+		// Display
+		if (display) Display("Building", "Objects", project.objSrcDir);
+
+		// Create Directory
+		MkDir(GetDir(project.objLib));
+
+		// Archive Command
+		String objLibCmd = project.archiver + " rcs " + project.objLibArc + " " + Concat(objects);
+
+		// Shared Object Command
+		if (project.objLibShared)
+		{
+			objLibCmd  = project.compiler;
+			objLibCmd += " "            + project.compPreFlags;
+			objLibCmd += " -shared -o " + project.objLibSo;
+			objLibCmd += " "            + Concat(objects);
+			objLibCmd += " "            + project.compPostFlags;
+			objLibCmd += project.ltoLinkFlags;
+		}
+
+		Job job(objLibCmd, project.objLib, JobLink);
+		job.dir    = project.dir;
+		job.after  = QualifiedIds(rebuilt);
+		job.lto    = project.objLibShared && !project.ltoLinkFlags.empty();
+		job.cutoff = cutoff;
+
+		// Cacheable (Shared Object Only, Archiving is Cheap)
+		if (project.objLibShared)
+		{
+			CacheJob(job, project.compiler, VecS(objects.begin(), objects.end()), VecI());
+		}
+
+		jobs.push_back(job);
+	}
+}
+
+// Collect App and Unit-Test Jobs (Waiting for the Libraries They Link)
+void CollectBinaries(Project& project, const VecP& projects, VecJ& jobs, VecJ& ppJobs)
+{
+	// Outputs Being Rebuilt
+	SetS scheduled;
+	for (VecJ::iterator j = jobs.begin(); j != jobs.end(); ++j)
+	{
+		scheduled.insert(InDir(j->dir, j->output));
+	}
+
+	// Libraries Linked (Own Object Library and Those of Dependencies)
+	VecS libs(1, Qualify(project.objLib));
+	for (VecI::const_iterator d = project.deps.begin(); d != project.deps.end(); ++d)
+	{
+		libs.push_back(InDir(projects[*d].dir, projects[*d].objLib));
+	}
+
+	// Library Selected by a Target (Every Binary Linking It is Too)
+	bool libSelected = Targets.empty() || project.libSelected;
+	for (VecI::const_iterator d = project.deps.begin(); d != project.deps.end(); ++d)
+	{
+		libSelected = libSelected || projects[*d].libSelected;
+	}
+
+	// Static Library Being Rebuilt (Forces Relinks)
+	String rebuiltLib;
+	if (!project.objLibShared && scheduled.count(libs[0]))
+	{
+		rebuiltLib = project.objLib;
+	}
+	for (int d = 0; d < project.deps.size() && rebuiltLib.empty(); d++)
+	{
+		if (!projects[project.deps[d]].objLibShared && scheduled.count(libs[d + 1]))
+		{
+			rebuiltLib = libs[d + 1];
+		}
+	}
+
+	////////////////
+	// Build Apps //
+	////////////////
+
+	{
+		// Application Descriptions
+		VecVecS appDescs = GetValsM("AppDir");
+
+		// For Each Application Description
+		for (VecVecS::iterator a = appDescs.begin(); a != appDescs.end(); ++a)
+		{
+			First display;
+
+			// Application Description
+			const VecS& appDesc = *a;
+
+			// Validate Description
+			if (appDesc.size() != 3 || appDesc[1] != "=>")
+			{
+				std::cerr << "Bad format in Recipe for AppDir, must be of the form 'appDir => binDir' not " << Concat(appDesc) << std::endl;
+				Abort();
+			}
+
+			// Application Directories
+			String pAppSrcDir = appDesc[0];
+			String pAppBinDir = appDesc[2];
+			String pAppObjDir = Join(GetVal("ObjectBinDir"), FlatName(pAppSrcDir));
+			MkDir(pAppBinDir);
+			MkDir(pAppObjDir);
+
+			// Application Source Files
+			VecS appSrcFiles = ListFiles(pAppSrcDir);
+
+			// For Each Application Source File
+			for (VecS::iterator a = appSrcFiles.begin(); a != appSrcFiles.end(); ++a)
+			{
+				// Only C++ Files
+				if (!EndsWith(*a, ".cpp"))
+				{
+					continue;
+				}
+
+				// Application Source, Object and Binary Files
+				String appSrcFile = Join(pAppSrcDir, *a);
+				String appObjFile = Join(pAppObjDir, ChopEnd(*a, 4) + ".o");
+				String appBinFile = Join(pAppBinDir, ChopEnd(*a, 4));
+
+				// Includes (Only Scanned for Selection When a Target May Be an Include)
+				VecI includes;
+				if (IncludeTargets)
+				{
+					GetAllIncls(PathId(appSrcFile), includes);
+				}
+
+				// Not Selected
+				bool selected = Targeted(ChopEnd(*a, 4), appBinFile, appSrcFile, includes);
+				selected = Targeted("", appObjFile, "", VecI()) || selected;
+				if (!selected && !libSelected)
+				{
+					continue;
+				}
+				Selected.insert(PathId(appBinFile));
+
+				// Includes for Up-to-Date Checks (Not When Generating, ninja Reads Depfiles)
+				if (!IncludeTargets && GenMode.empty())
+				{
+					GetAllIncls(PathId(appSrcFile), includes);
+				}
+
+				// Compile and Link
+				CollectBinary(project, appSrcFile, appObjFile, appBinFile, includes, libs, rebuiltLib, jobs, ppJobs, display, "Apps", pAppSrcDir);
+			}
+		}
+	}
+
+
+	//////////////////////////
+	// Build Unit-Test Apps //
+	//////////////////////////
+
+	{
+		// Unit-Test-Run Script (Not Written When Only Planning)
+		String unitScript = GetVal("UnitTestScript");
+		std::ofstream unitStream;
+		if (!PlanOnly)
+		{
+			unitStream.open(unitScript.c_str());
+		}
+
+		if (!PlanOnly && !unitStream)
+		{
+			std::cerr << "Unable to create unit-test script: " << unitScript << std::endl;
+			Abort();
+		}
+
+		// Unit-Test Descriptions
+		VecVecS unitDescs = GetValsM("UnitTestDir");
+
+		// For Each Unit-Test Description
+		for (VecVecS::iterator u = unitDescs.begin(); u != unitDescs.end(); ++u)
+		{
+			First display;
+
+			// Unit-Test Description
+			const VecS& unitDesc = *u;
+
+			// Validate Description
+			if (unitDesc.size() != 3 || unitDesc[1] != "=>")
+			{
+				std::cerr << "Bad format in Recipe for UnitTestDir, must be of the form 'unitDir => binDir' not " << Concat(unitDesc) << std::endl;
+				Abort();
+			}
+
+			// Unit-Test Directories
+			String pUnitSrcDir = unitDesc[0];
+			String pUnitBinDir = unitDesc[2];
+			String pUnitObjDir = Join(GetVal("ObjectBinDir"), FlatName(pUnitSrcDir));
+			MkDir(pUnitBinDir);
+			MkDir(pUnitObjDir);
+
+			// Unit-Test Source Files
+			VecS unitSrcFiles = ListFiles(pUnitSrcDir);
+
+			// Runner Binary, Its Unit-Tests and Objects, and an Object Being Rebuilt (Runner Mode)
+			String runnerBinFile = Join(pUnitBinDir, FlatName(pUnitSrcDir) + "_runner");
+			VecS   runnerNames;
+			VecS   runnerObjFiles;
+			String rebuiltObj;
+
+			// For Each Unit-Test Source File
+			for (VecS::iterator a = unitSrcFiles.begin(); a != unitSrcFiles.end(); ++a)
+			{
+				// Only C++ Files
+				if (!EndsWith(*a, ".cpp"))
+				{
+					continue;
+				}
+
+				// Unit-Test Name, Source, Object and Binary Files
+				String unitName    = ChopEnd(*a, 4);
+				String unitSrcFile = Join(pUnitSrcDir, *a);
+				String unitObjFile = Join(pUnitObjDir, unitName + ".o");
+				String unitBinFile = Join(pUnitBinDir, unitName);
+
+				// Run Command (Own Binary, or the Runner Given the Unit-Test Name)
+				String unitCmd = project.unitRunner ? "./" + runnerBinFile + " " + unitName : "./" + unitBinFile;
+
+				// Add to Unit-Test-Run Script
+				unitStream << unitCmd << std::endl;
+
+				// Includes (Only Scanned for Selection When a Target May Be an Include)
+				VecI includes;
+				if (IncludeTargets)
+				{
+					GetAllIncls(PathId(unitSrcFile), includes);
+				}
+
+				// Not Selected (A Runner Links Every Unit-Test, So Only the Selected Run)
+				bool selected = Targeted(unitName, project.unitRunner ? runnerBinFile : unitBinFile, unitSrcFile, includes);
+				selected = Targeted("", unitObjFile, "", VecI()) || selected || libSelected;
+				if (!selected && !project.unitRunner)
+				{
+					continue;
+				}
+
+				// Includes for Up-to-Date Checks and Affected Tests (Not When Generating, ninja Reads Depfiles)
+				if (!IncludeTargets && GenMode.empty())
+				{
+					GetAllIncls(PathId(unitSrcFile), includes);
+				}
+
+				// Remember for Affected-Test Selection (A Runner Changes With Every Unit-Test, So Its Object Stands In)
+				if (selected)
+				{
+					Selected.insert(PathId(project.unitRunner ? runnerBinFile : unitBinFile));
+					project.unitFiles.push_back(project.unitRunner ? unitObjFile : unitBinFile);
+					project.unitIncludes.push_back(includes);
+					project.unitCmds.push_back(unitCmd);
+				}
+
+				// Compile Only (main Emitted as the Entry Point), Linked Into the Runner Below
+				if (project.unitRunner)
+				{
+					// Entry Header (Rewritten Only When main's Form Changes; Only Planning, Its Object Rebuilds)
+					String entryFile   = Join(pUnitObjDir, unitName + ".entry.h");
+					String entryHeader = RunnerEntryHeader(unitName, MainTakesArgs(ReadFile(unitSrcFile)));
+					bool   entryChange = ReadFile(entryFile) != entryHeader;
+					if (entryChange && PlanOnly)
+					{
+						PlannedMissing.insert(Qualify(unitObjFile));
+					}
+					else if (entryChange && !WriteFile(entryFile, entryHeader))
+					{
+						std::cerr << "Unable to create unit-test entry header: " << entryFile << std::endl;
+						Abort();
+					}
+
+					String reason = CollectCompile(project, unitSrcFile, unitObjFile, includes, " -include " + entryFile, jobs, ppJobs);
+					if (!reason.empty() && rebuiltObj.empty())
+					{
+						rebuiltObj = unitObjFile;
+					}
+
+					runnerNames.push_back(unitName);
+					runnerObjFiles.push_back(unitObjFile);
+					continue;
+				}
+
+				// Compile and Link
+				CollectBinary(project, unitSrcFile, unitObjFile, unitBinFile, includes, libs, rebuiltLib, jobs, ppJobs, display, "Unit-Tests", pUnitSrcDir);
+			}
+
+			// Runner (One Link for Every Unit-Test of the Directory)
+			if (!runnerNames.empty())
+			{
+				// Dispatch Table Source (Rewritten Only When the Unit-Tests Change; Only Planning, Its Object Rebuilds)
+				String runnerSrcFile = Join(pUnitObjDir, "bake_runner.cpp");
+				String runnerObjFile = Join(pUnitObjDir, "bake_runner.o");
+				String runnerSource  = RunnerSource(runnerNames);
+				bool   runnerChange  = ReadFile(runnerSrcFile) != runnerSource;
+				if (runnerChange && PlanOnly)
+				{
+					PlannedMissing.insert(Qualify(runnerObjFile));
+				}
+				else if (runnerChange && !WriteFile(runnerSrcFile, runnerSource))
+				{
+					std::cerr << "Unable to create unit-test runner source: " << runnerSrcFile << std::endl;
+					Abort();
+				}
+
+				String reason = CollectCompile(project, runnerSrcFile, runnerObjFile, VecI(), "", jobs, ppJobs);
+				if (!reason.empty() && rebuiltObj.empty())
+				{
+					rebuiltObj = runnerObjFile;
+				}
+				runnerObjFiles.push_back(runnerObjFile);
+
+				CollectLink(project, runnerSrcFile, runnerObjFiles, rebuiltObj, runnerBinFile, libs, rebuiltLib, jobs, display, "Unit-Tests", pUnitSrcDir);
+			}
+		}
+
+		// Close Unit-Test-Run Script
+		unitStream.close();
+	}
+}
+
+// Collect Compile and Link Jobs of an App or Unit-Test (Links Wait for Their Object and Libraries)
+void CollectBinary(Project& project, const String& srcFile, const String& objFile, const String& binFile, const VecI& includes, const VecS& libs, const String& rebuiltLib, VecJ& jobs, VecJ& ppJobs, First& display, const String& label, const String& srcDir)
+{
+	String compileReason = CollectCompile(project, srcFile, objFile, includes, "", jobs, ppJobs);
+	CollectLink(project, srcFile, VecS(1, objFile), compileReason.empty() ? "" : objFile, binFile, libs, rebuiltLib, jobs, display, label, srcDir);
+}
+
+// Collect Compile Job of an App, Unit-Test or Runner Object (Returns Why It Runs, Empty When Up to Date)
+String CollectCompile(Project& project, const String& srcFile, const String& objFile, const VecI& includes, const String& flags, VecJ& jobs, VecJ& ppJobs)
+{
+	// Module Unit (Flags, Interfaces Waited For, Why It Rebuilds)
+	String moduleFlags;
+	VecS   moduleAfter;
+	String moduleReason;
+	bool   moduleUnit = ModuleDeps(project, srcFile, objFile, moduleFlags, moduleAfter, moduleReason);
+
+	// Compile Command
+	String cmd = project.compiler;
+	cmd += " "    + project.compPreFlags;
+	cmd += " -c " + srcFile;
+	cmd += " -o " + objFile;
+	cmd += " "    + project.includeFlags;
+	cmd += " "    + project.compPostFlags;
+	cmd += project.ltoCompFlags;
+	cmd += project.dwarfFlags;
+	cmd += flags;
+	cmd += moduleFlags;
+
+	// Preprocess Command
+	String ppFile = objFile + ".ii";
+	String ppCmd  = project.compiler;
+	ppCmd += " "    + project.compPreFlags;
+	ppCmd += " -E " + srcFile;
+	ppCmd += " -o " + ppFile;
+	ppCmd += " "    + project.includeFlags;
+	ppCmd += " "    + project.compPostFlags;
+	ppCmd += flags;
+
+	// Compile Analysis (Preprocessed Size; Not of Module Units, They Need BMIs)
+	if (!AnalyzeMode.empty() && !moduleUnit)
+	{
+		Job ppJob(ppCmd, ppFile, srcFile, JobCompile);
+		ppJob.dir    = project.dir;
+		ppJob.record = false;
+		ppJobs.push_back(ppJob);
+	}
+
+	// Check Need-to-Compile (And Why)
+	String compileReason;
+	OutputsChecked++;
+
+	// No Object
+	if (Missing(objFile))
+	{
+		compileReason = "missing output";
+	}
+	// No Split Debug Info
+	else if (!project.dwarfFlags.empty() && !FileExists(DwoFile(objFile)))
+	{
+		compileReason = "missing output " + DwoFile(objFile);
+	}
+	// Source Modified
+	else if (GetFileModTm(srcFile) > GetFileModTm(objFile))
+	{
+		compileReason = NewerReason(srcFile, objFile);
+	}
+	// Include Modified
+	else if (GetFileModTm(includes) > GetFileModTm(objFile))
+	{
+		compileReason = NewerReason(NewestFile(includes), objFile);
+	}
+	// Command Changed
+	else if (CommandChanged(objFile, cmd))
+	{
+		compileReason = "command changed";
+	}
+	// Imported BMI
+	else if (!moduleReason.empty())
+	{
+		compileReason = moduleReason;
+	}
+
+	// Need To Compile (Remote-Capable Unless a Module Unit, Split Debug Info or Flags Workers Refuse)
+	if (!compileReason.empty())
+	{
+		Job job(cmd, objFile, srcFile, JobCompile);
+		job.dir   = project.dir;
+		job.after = QualifiedIds(moduleAfter);
+		if (!moduleUnit && project.dwarfFlags.empty())
+		{
+			String ccCmd = RemoteCompileCmd(project.compiler, project.compPreFlags + " " + project.compPostFlags + project.ltoCompFlags);
+			if (!ccCmd.empty())
+			{
+				job.ppFile = ppFile;
+				job.ppCmd  = ppCmd;
+				job.ccCmd  = ccCmd;
+			}
+
+			// Cacheable (Not Module Units Nor Split Debug Info)
+			CacheJob(job, project.compiler, VecS(1, srcFile), includes);
+		}
+		jobs.push_back(job);
+
+		// Explain
+		Explain(objFile, compileReason);
+	}
+
+	return compileReason;
+}
+
+// Collect Link Job of a Binary (Waits for Its Objects and Libraries; rebuiltObj Names an Object Being Rebuilt)
+void CollectLink(Project& project, const String& srcFile, const VecS& objFiles, const String& rebuiltObj, const String& binFile, const VecS& libs, const String& rebuiltLib, VecJ& jobs, First& display, const String& label, const String& srcDir)
+{
+	SetS objSet(objFiles.begin(), objFiles.end());
+
+	// Link Command
+	String linkCmd = project.compiler;
+	linkCmd += " "    + project.compPreFlags;
+	linkCmd += " "    + Concat(objFiles);
+	linkCmd += " -o " + binFile;
+	linkCmd += " "    + project.libraryFlags;
+	linkCmd += " "    + project.compPostFlags;
+	linkCmd += project.ltoLinkFlags;
+
+	// Check Need-to-Link (And Why)
+	String staleReason;
+	OutputsChecked++;
+
+	// No Binary
+	if (Missing(binFile))
+	{
+		staleReason = "missing output";
+	}
+	// Object Modified
+	else if (GetFileModTm(objSet) > GetFileModTm(binFile))
+	{
+		staleReason = NewerReason(NewestFile(objSet), binFile);
+	}
+	// Object Library Modified (Static Only)
+	else if (!project.objLibShared && GetFileModTm(project.objLibArc) > GetFileModTm(binFile))
+	{
+		staleReason = NewerReason(project.objLibArc, binFile);
+	}
+	// Object Library Type Changed
+	else if (Missing(project.objLibStamp) || GetFileModTm(project.objLibStamp) > GetFileModTm(binFile))
+	{
+		staleReason = NewerReason(project.objLibStamp, binFile);
+	}
+	// Library-File Modified
+	else if (GetFileModTm(project.libFileNames) > GetFileModTm(binFile))
+	{
+		staleReason = NewerReason(NewestFile(project.libFileNames), binFile);
+	}
+	// Command Changed
+	else if (CommandChanged(binFile, linkCmd))
+	{
+		staleReason = "command changed";
+	}
+
+	// Object Being Rebuilt, Else Stale, Else Object Library Being Rebuilt (Static Only)
+	String linkReason = staleReason;
+	if (!rebuiltObj.empty())
+	{
+		linkReason = "rebuilt input " + rebuiltObj;
+	}
+	else if (linkReason.empty() && !rebuiltLib.empty())
+	{
+		linkReason = "rebuilt input " + rebuiltLib;
+	}
+
+	// Display
+	if (!linkReason.empty() && display) Display("Building", label, srcDir);
+
+	// Need To Link
+	if (!linkReason.empty())
+	{
+		Job job(linkCmd, binFile, srcFile, JobLink);
+		job.dir   = project.dir;
+		job.after = QualifiedIds(libs);
+		for (VecS::const_iterator o = objFiles.begin(); o != objFiles.end(); ++o)
+		{
+			job.after.push_back(PathId(*o));
+		}
+		job.lto    = !project.ltoLinkFlags.empty();
+		job.cutoff = staleReason.empty();
+
+		// Cacheable (Keyed by Objects and Libraries Linked)
+		VecS inputs = objFiles;
+		inputs.insert(inputs.end(), libs.begin(), libs.end());
+		inputs.insert(inputs.end(), project.libFileNames.begin(), project.libFileNames.end());
+		CacheJob(job, project.compiler, inputs, VecI());
+
+		jobs.push_back(job);
+
+		// Explain
+		Explain(binFile, linkReason);
+	}
+
+	// Debug Package (In the Background, After the Binary)
+	if (!project.dwp.empty())
+	{
+		String dwpFile = binFile + ".dwp";
+		String dwpReason;
+		OutputsChecked++;
+
+		// Binary Being Relinked
+		if (!linkReason.empty())
+		{
+			dwpReason = "rebuilt input " + binFile;
+		}
+		// No Package
+		else if (Missing(dwpFile))
+		{
+			dwpReason = "missing output";
+		}
+		// Binary Modified
+		else if (GetFileModTm(binFile) > GetFileModTm(dwpFile))
+		{
+			dwpReason = NewerReason(binFile, dwpFile);
+		}
+
+		if (!dwpReason.empty())
+		{
+			Job job(project.dwp + " -e " + binFile + " -o " + dwpFile, dwpFile, srcFile, JobLink);
+			job.dir        = project.dir;
+			job.after      = VecI(1, PathId(binFile));
+			job.background = true;
+			job.cutoff     = !linkReason.empty();
+			jobs.push_back(job);
+
+			// Explain
+			Explain(dwpFile, dwpReason);
+		}
+	}
+}
+
+// Split Debug Info File of an Object
+String DwoFile(const String& objFile)
+{
+	return ChopEnd(objFile, 2) + ".dwo";
+}
+
+// Unit-Test Entry Point in a Runner (Name Made an Identifier, the Form of main Suffixed)
+String RunnerEntry(const String& name)
+{
+	String entry = "bake_test_" + name;
+	for (int i = 0; i < entry.size(); i++)
+	{
+		if (!isalnum(entry[i]))
+		{
+			entry[i] = '_';
+		}
+	}
+
+	return entry;
+}
+
+// main Takes argc and argv (Its First Definition in the Source)
+bool MainTakesArgs(const String& source)
+{
+	for (size_t at = source.find("main"); at != String::npos; at = source.find("main", at + 4))
+	{
+		// Whole Word, Preceded by int
+		size_t before = source.find_last_not_of(" \t\r\n", at == 0 ? 0 : at - 1);
+		if (at == 0 || before == String::npos || before < 2 || source.compare(before - 2, 3, "int") != 0 || isalnum(source[at - 1]) || source[at - 1] == '_')
+		{
+			continue;
+		}
+
+		// Followed by Its Parameters
+		size_t open = source.find_first_not_of(" \t\r\n", at + 4);
+		if (open == String::npos || source[open] != '(')
+		{
+			continue;
+		}
+
+		size_t close = source.find(')', open);
+		String params = close == String::npos ? "" : source.substr(open + 1, close - open - 1);
+		VecS words = Split(params);
+		return !(words.empty() || (words.size() == 1 && words[0] == "void"));
+	}
+
+	return false;
+}
+
+// Unit-Test Entry Header (Forced Include Declaring main With the Entry Point as Its Symbol, So It Stays main to the Compiler)
+String RunnerEntryHeader(const String& name, bool takesArgs)
+{
+	// main Still Returns 0 When Falling Off Its End, and No Other main is Touched (Unlike a -Dmain Macro)
+	std::ostringstream header;
+	header << "// Unit-Test Entry (Generated by bake)" << std::endl;
+	if (takesArgs)
+	{
+		header << "int main(int, char**) __asm__(\"" << RunnerEntry(name) << "_2\");" << std::endl;
+	}
+	else
+	{
+		header << "int main() __asm__(\"" << RunnerEntry(name) << "_0\");" << std::endl;
+	}
+
+	return header.str();
+}
+
+// Unit-Test Runner Source (Entry Points Declared Weak in Both Forms of main, the One Defined is Called)
+String RunnerSource(const VecS& names)
+{
+	std::ostringstream src;
+	src << "// Unit-Test Runner (Generated by bake)" << std::endl;
+	src << "#include <stdio.h>" << std::endl;
+	src << "#include <stdlib.h>" << std::endl;
+	src << "#include <string.h>" << std::endl;
+	src << "#include <unistd.h>" << std::endl;
+	src << "#include <sys/wait.h>" << std::endl;
+	src << std::endl;
+
+	// Entry Points
+	for (VecS::const_iterator n = names.begin(); n != names.end(); ++n)
+	{
+		src << "extern \"C\" int " << RunnerEntry(*n) << "_0() __attribute__((weak));" << std::endl;
+		src << "extern \"C\" int " << RunnerEntry(*n) << "_2(int, char**) __attribute__((weak));" << std::endl;
+	}
+	src << std::endl;
+
+	// Dispatch Table
+	src << "struct Test { const char* name; int (*main0)(); int (*main2)(int, char**); };" << std::endl;
+	src << std::endl;
+	src << "static Test tests[] =" << std::endl;
+	src << "{" << std::endl;
+	for (VecS::const_iterator n = names.begin(); n != names.end(); ++n)
+	{
+		src << "    { \"" << *n << "\", " << RunnerEntry(*n) << "_0, " << RunnerEntry(*n) << "_2 }," << std::endl;
+	}
+	src << "};" << std::endl;
+	src << std::endl;
+	src << "static const int nTests = sizeof(tests) / sizeof(tests[0]);" << std::endl;
+	src << std::endl;
+
+	// Run One Test (In This Process)
+	src << "static int Run(const Test& test, int argc, char** argv)" << std::endl;
+	src << "{" << std::endl;
+	src << "    return test.main2 ? test.main2(argc, argv) : test.main0();" << std::endl;
+	src << "}" << std::endl;
+	src << std::endl;
+
+	// Usage: runner --list | runner name [args] | runner [-jN] (Every Test, Forked)
+	src << "int main(int argc, char** argv)" << std::endl;
+	src << "{" << std::endl;
+	src << "    // List Tests" << std::endl;
+	src << "    if (argc > 1 && strcmp(argv[1], \"--list\") == 0)" << std::endl;
+	src << "    {" << std::endl;
+	src << "        for (int t = 0; t < nTests; t++) printf(\"%s\\n\", tests[t].name);" << std::endl;
+	src << "        return 0;" << std::endl;
+	src << "    }" << std::endl;
+	src << std::endl;
+	src << "    // One Test (Remaining Arguments Are Its Own)" << std::endl;
+	src << "    if (argc > 1 && argv[1][0] != '-')" << std::endl;
+	src << "    {" << std::endl;
+	src << "        for (int t = 0; t < nTests; t++)" << std::endl;
+	src << "        {" << std::endl;
+	src << "            if (strcmp(argv[1], tests[t].name) == 0) return Run(tests[t], argc - 1, argv + 1);" << std::endl;
+	src << "        }" << std::endl;
+	src << "        fprintf(stderr, \"Unknown unit-test: %s\\n\", argv[1]);" << std::endl;
+	src << "        return 2;" << std::endl;
+	src << "    }" << std::endl;
+	src << std::endl;
+	src << "    // Every Test, Each in a Forked Process (-jN at Once)" << std::endl;
+	src << "    int nSpawn = (argc > 1 && strncmp(argv[1], \"-j\", 2) == 0) ? atoi(argv[1] + 2) : 1;" << std::endl;
+	src << "    if (nSpawn < 1) nSpawn = 1;" << std::endl;
+	src << std::endl;
+	src << "    pid_t pids[sizeof(tests) / sizeof(tests[0])];" << std::endl;
+	src << "    int next = 0, running = 0, failed = 0;" << std::endl;
+	src << "    while (next < nTests || running > 0)" << std::endl;
+	src << "    {" << std::endl;
+	src << "        if (next < nTests && running < nSpawn)" << std::endl;
+	src << "        {" << std::endl;
+	src << "            fflush(stdout);" << std::endl;
+	src << "            fflush(stderr);" << std::endl;
+	src << "            pids[next] = fork();" << std::endl;
+	src << "            if (pids[next] == 0)" << std::endl;
+	src << "            {" << std::endl;
+	src << "                char* args[] = { (char*)tests[next].name, 0 };" << std::endl;
+	src << "                exit(Run(tests[next], 1, args));" << std::endl;
+	src << "            }" << std::endl;
+	src << "            next++;" << std::endl;
+	src << "            running++;" << std::endl;
+	src << "            continue;" << std::endl;
+	src << "        }" << std::endl;
+	src << std::endl;
+	src << "        int status;" << std::endl;
+	src << "        pid_t pid = wait(&status);" << std::endl;
+	src << "        if (pid < 0) break;" << std::endl;
+	src << "        running--;" << std::endl;
+	src << "        for (int t = 0; t < next; t++)" << std::endl;
+	src << "        {" << std::endl;
+	src << "            if (pids[t] == pid && !(WIFEXITED(status) && WEXITSTATUS(status) == 0))" << std::endl;
+	src << "            {" << std::endl;
+	src << "                fprintf(stderr, \"FAILED: %s\\n\", tests[t].name);" << std::endl;
+	src << "                failed++;" << std::endl;
+	src << "            }" << std::endl;
+	src << "        }" << std::endl;
+	src << "    }" << std::endl;
+	src << std::endl;
+	src << "    printf(\"%d of %d unit-tests passed\\n\", nTests - failed, nTests);" << std::endl;
+	src << "    return failed ? 1 : 0;" << std::endl;
+	src << "}" << std::endl;
+
+	return src.str();
+}
+
+// Run Unit-Tests Whose Inputs Changed
+void RunUnitTests(Project& project)
+{
+	// Unit-Test-Run Script (Runs Every Unit-Test)
+	System("chmod u+x " + GetVal("UnitTestScript"));
+
+	// Shared Inputs (Object Library and Library Files, Hashed Once for Every Unit-Test)
+	SetS sharedInputs = project.libFileNames;
+	sharedInputs.insert(project.objLib);
+	String sharedDigest = SharedInputsDigest(sharedInputs);
+
+	int skipped = 0;
+	for (int t = 0; t < project.unitFiles.size(); t++)
+	{
+		const String& unitFile = project.unitFiles[t];
+		String inputHash = TestInputHash(unitFile, project.unitIncludes[t], sharedDigest);
+
+		// Passed Before With Same Inputs
+		bool passed = TestPassed(Qualify(unitFile), inputHash);
+		if (!IsOn("alltests") && passed)
+		{
+			skipped++;
+			TestsSkipped++;
+			continue;
+		}
+
+		// Explain (Keyed by the Unit-Test Binary, or Its Object in a Runner, Like Jobs by Output)
+		Explain(unitFile, passed ? "all unit-tests requested" : "no passing run with these inputs");
+
+		TestsRun++;
+		if (System(project.unitCmds[t]) == 0)
+		{
+			RecordTestPass(Qualify(unitFile), inputHash);
+		}
+	}
+
+	// Display
+	if (skipped > 0)
+	{
+		std::cout << Prefix << FgBlu() << "Skipped: " << FgOff() << skipped << " unit-tests with unchanged inputs (-alltests runs them)" << std::endl;
+	}
+}
+
+
+
+////////////////////////////////////////
+// Header Fingerprints Implementation //
+////////////////////////////////////////
+
+// Load Header Fingerprints (Path, Time, Hash; One Line Each)
+void LoadHeaderPrints()
+{
+	std::ifstream stream(Join(StateDir, "HeaderPrints").c_str());
+
+	String path;
+	int    modTm;
+	String print;
+	while (stream >> path >> modTm >> print)
+	{
+		HeaderPrints[path] = std::make_pair(modTm, print);
+	}
+}
+
+// Save Header Fingerprints (Written Aside, Then Renamed)
+void SaveHeaderPrints()
+{
+	MkDir(StateDir);
+
+	String path = Join(StateDir, "HeaderPrints");
+	String temp = path + ".tmp";
+
+	std::ofstream stream(temp.c_str());
+	for (std::map<String, std::pair<int, String> >::iterator h = HeaderPrints.begin(); h != HeaderPrints.end(); ++h)
+	{
+		stream << h->first << " " << h->second.first << " " << h->second.second << std::endl;
+	}
+	stream.close();
+
+	rename(temp.c_str(), path.c_str());
+}
+
+// Token Stream of Source Text (Comments Dropped, Whitespace Collapsed, Literals Kept)
+String TokenStream(const String& text)
+{
+	String result;
+	bool space = false;
+
+	size_t i = 0;
+	while (i < text.size())
+	{
+		char c = text[i];
+		char n = i + 1 < text.size() ? text[i + 1] : 0;
+
+		// Line Comment (The Newline Stays)
+		if (c == '/' && n == '/')
+		{
+			i = text.find('\n', i);
+			i = (i == String::npos) ? text.size() : i;
+			space = true;
+		}
+		// Block Comment
+		else if (c == '/' && n == '*')
+		{
+			i = text.find("*/", i + 2);
+			i = (i == String::npos) ? text.size() : i + 2;
+			space = true;
+		}
+		// Newline (Directives End at Line Ends, Blank Lines Dropped)
+		else if (c == '\n')
+		{
+			if (!result.empty() && result[result.size() - 1] != '\n')
+			{
+				result += '\n';
+			}
+			space = false;
+			i++;
+		}
+		// Whitespace
+		else if (isspace((unsigned char)c))
+		{
+			space = true;
+			i++;
+		}
+		// Token Text
+		else
+		{
+			if (space && !result.empty() && result[result.size() - 1] != '\n')
+			{
+				result += ' ';
+			}
+			space = false;
+
+			// Raw String Literal (Kept Whole Up to )delim")
+			if (c == '"' && i > 0 && text[i - 1] == 'R')
+			{
+				size_t open = text.find('(', i);
+				String close = ")" + text.substr(i + 1, open == String::npos ? 0 : open - i - 1) + "\"";
+				size_t end = text.find(close, i + 1);
+				end = (end == String::npos) ? text.size() : end + close.size();
+				result.append(text, i, end - i);
+				i = end;
+			}
+			// String or Character Literal (Kept Whole)
+			else if (c == '"' || c == '\'')
+			{
+				size_t end = i + 1;
+				while (end < text.size() && text[end] != c && text[end] != '\n')
+				{
+					end += (text[end] == '\\') ? 2 : 1;
+				}
+				end = end < text.size() ? end + 1 : text.size();
+				result.append(text, i, end - i);
+				i = end;
+			}
+			else
+			{
+				result += c;
+				i++;
+			}
+		}
+	}
+
+	// Final Newline Dropped
+	if (!result.empty() && result[result.size() - 1] == '\n')
+	{
+		result.erase(result.size() - 1);
+	}
+
+	return result;
+}
+
+// Record Fingerprint of a Scanned File (Sets the Time Its Token Stream Last Changed)
+void RecordPrint(int file, const String& text)
+{
+	StatPath(file);
+	String print = Hash(TokenStream(text));
+
+	// Token Stream Changed (Or Not Seen Before) When the File Was Last Modified
+	std::pair<int, String>& recorded = HeaderPrints[PathStr(file)];
+	if (recorded.second != print)
+	{
+		recorded.first  = Paths.modTm[file];
+		recorded.second = print;
+	}
+
+	Paths.sameTm[file] = recorded.first;
+}
+
+// Include Modification Time (Time the Token Stream Last Changed, in Fingerprint Mode)
+int InclModTm(int file)
+{
+	StatPath(file);
+
+	int sameTm = Paths.sameTm[file];
+	if (FingerprintMode && sameTm > 0 && sameTm < Paths.modTm[file])
+	{
+		return sameTm;
+	}
+
+	return Paths.modTm[file];
+}
+
+
+
+////////////////////////////////
+// Run History Implementation //
+////////////////////////////////
+
+// Load Run Records (One Line Each: name=value, and @output=wall for Jobs)
+VecR LoadRuns()
+{
+	VecR runs;
+	std::ifstream stream(Join(StateDir, "RunHistory").c_str());
+
+	String line;
+	while (getline(stream, line))
+	{
+		RunRecord run;
+
+		VecS tokens = Split(line);
+		for (VecS::iterator t = tokens.begin(); t != tokens.end(); ++t)
+		{
+			size_t eq = t->rfind('=');
+			if (eq == String::npos)
+			{
+				continue;
+			}
+
+			if ((*t)[0] == '@')
+			{
+				run.jobs[t->substr(1, eq - 1)] = atof(t->c_str() + eq + 1);
+			}
+			else
+			{
+				run.values[t->substr(0, eq)] = atof(t->c_str() + eq + 1);
+			}
+		}
+
+		if (!run.values.empty())
+		{
+			runs.push_back(run);
+		}
+	}
+
+	return runs;
+}
+
+// Append Run Record (Written Aside With the Most Recent Records, Then Renamed)
+void RecordRun(const MapSD& values)
+{
+	MkDir(StateDir);
+
+	String path = Join(StateDir, "RunHistory");
+	String temp = path + ".tmp";
+
+	// Kept Records
+	VecS kept;
+	std::ifstream in(path.c_str());
+	String line;
+	while (getline(in, line))
+	{
+		kept.push_back(line);
+	}
+	in.close();
+
+	if (kept.size() >= RunHistoryKept)
+	{
+		kept.erase(kept.begin(), kept.end() - (RunHistoryKept - 1));
+	}
+
+	// This Run
+	std::ostringstream record;
+	for (MapSD::const_iterator v = values.begin(); v != values.end(); ++v)
+	{
+		record << (v == values.begin() ? "" : " ") << v->first << "=" << std::setprecision(12) << (long)(v->second * 1000 + 0.5) / 1000.0;
+	}
+	for (VecJS::iterator j = RunStats.begin(); j != RunStats.end(); ++j)
+	{
+		record << " @" << j->output << "=" << std::setprecision(4) << j->wall;
+	}
+	kept.push_back(record.str());
+
+	std::ofstream stream(temp.c_str());
+	for (VecS::iterator k = kept.begin(); k != kept.end(); ++k)
+	{
+		stream << *k << std::endl;
+	}
+	stream.close();
+
+	rename(temp.c_str(), path.c_str());
+}
+
+// Median (0 When Empty)
+double Median(std::vector<double> values)
+{
+	if (values.empty())
+	{
+		return 0;
+	}
+
+	std::sort(values.begin(), values.end());
+	size_t mid = values.size() / 2;
+	return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+// Regression of the Latest Run
+struct Regression
+{
+	String kind;      // phase or job
+	String name;
+	double latest;    // Seconds
+	double baseline;  // Median Seconds of Earlier Runs
+};
+
+// Report Trends of the Last n Runs, and Regressions of the Latest Run Beyond threshold (Fraction) Against the Median of Earlier Runs
+void ReportRuns(int n, double threshold, bool json)
+{
+	VecR runs = LoadRuns();
+	int first = Max((int)runs.size() - n, 0);
+
+	// Rolling Baseline (Up to 10 Runs Before the Latest, 3 Samples at Least)
+	const int window  = 10;
+	const int samples = 3;
+	const double minDelta = 0.05;
+
+	std::vector<Regression> regressions;
+	if (runs.size() >= 2)
+	{
+		RunRecord& latest = runs.back();
+		int from = Max((int)runs.size() - 1 - window, 0);
+
+		// Phases
+		const char* phases[] = { "wall", "plan", "build", "test" };
+		for (int p = 0; p < 4; p++)
+		{
+			std::vector<double> earlier;
+			for (int r = from; r < runs.size() - 1; r++)
+			{
+				earlier.push_back(runs[r].values[phases[p]]);
+			}
+
+			Regression reg;
+			reg.kind     = "phase";
+			reg.name     = phases[p];
+			reg.latest   = latest.values[phases[p]];
+			reg.baseline = Median(earlier);
+			if (earlier.size() >= samples && reg.latest > reg.baseline * (1 + threshold) && reg.latest - reg.baseline > minDelta)
+			{
+				regressions.push_back(reg);
+			}
+		}
+
+		// Jobs (Against Earlier Runs That Ran Them)
+		for (MapSD::iterator j = latest.jobs.begin(); j != latest.jobs.end(); ++j)
+		{
+			std::vector<double> earlier;
+			for (int r = from; r < runs.size() - 1; r++)
+			{
+				MapSD::iterator find = runs[r].jobs.find(j->first);
+				if (find != runs[r].jobs.end())
+				{
+					earlier.push_back(find->second);
+				}
+			}
+
+			Regression reg;
+			reg.kind     = "job";
+			reg.name     = j->first;
+			reg.latest   = j->second;
+			reg.baseline = Median(earlier);
+			if (earlier.size() >= samples && reg.latest > reg.baseline * (1 + threshold) && reg.latest - reg.baseline > minDelta)
+			{
+				regressions.push_back(reg);
+			}
+		}
+	}
+
+	// JSON
+	if (json)
+	{
+		std::cout << std::setprecision(12);
+		std::cout << "{" << std::endl << "  \"runs\": [";
+		for (int r = first; r < runs.size(); r++)
+		{
+			std::cout << (r > first ? "," : "") << std::endl << "    {";
+			for (MapSD::iterator v = runs[r].values.begin(); v != runs[r].values.end(); ++v)
+			{
+				std::cout << (v == runs[r].values.begin() ? "" : ", ") << JsonStr(v->first) << ": " << v->second;
+			}
+			std::cout << ", \"jobs\": " << runs[r].jobs.size() << "}";
+		}
+		std::cout << std::endl << "  ]," << std::endl << "  \"threshold\": " << threshold << "," << std::endl << "  \"regressions\": [";
+		for (int g = 0; g < regressions.size(); g++)
+		{
+			std::cout << (g ? "," : "") << std::endl << "    {\"kind\": " << JsonStr(regressions[g].kind) << ", \"name\": " << JsonStr(regressions[g].name)
+					  << ", \"latest\": " << regressions[g].latest << ", \"baseline\": " << regressions[g].baseline << "}";
+		}
+		std::cout << std::endl << "  ]" << std::endl << "}" << std::endl;
+		return;
+	}
+
+	// Trends
+	std::cout << Prefix << FgBlu() << "Runs:" << FgOff() << " (wall, plan, build, test seconds; rebuilt/checked outputs; stat cache hits; unit-tests run/skipped)" << std::endl;
+	for (int r = first; r < runs.size(); r++)
+	{
+		MapSD& v = runs[r].values;
+		double stats = v["statHit"] + v["statMiss"];
+
+		char line[160];
+		sprintf(line, "%8.2fs %8.2fs %8.2fs %8.2fs %6.0f/%-6.0f %5.1f%% %4.0f/%.0f",
+				v["wall"], v["plan"], v["build"], v["test"], v["rebuilt"], v["checked"],
+				stats > 0 ? 100 * v["statHit"] / stats : 0.0, v["testRun"], v["testSkip"]);
+		std::cout << Star() << FgYlw() << FormatTime((int)v["when"]) << FgOff() << " " << line << (v["failed"] > 0 ? FgRed() + " failed" + FgOff() : "") << std::endl;
+	}
+
+	// Regressions
+	char line[64];
+	sprintf(line, " (latest run > %.0f%% over the median of earlier runs)", threshold * 100);
+	std::cout << Prefix << FgBlu() << "Regressions:" << FgOff() << line << std::endl;
+	if (regressions.empty())
+	{
+		std::cout << Star() << "none" << std::endl;
+	}
+	for (int g = 0; g < regressions.size(); g++)
+	{
+		sprintf(line, "%8.2fs (was %.2fs, %.2fx) ", regressions[g].latest, regressions[g].baseline, regressions[g].baseline > 0 ? regressions[g].latest / regressions[g].baseline : 0.0);
+		std::cout << Star() << FgRed() << line << FgOff() << regressions[g].kind << " " << regressions[g].name << std::endl;
+	}
+}
+
+
+
+////////////////////////////
+// Targets Implementation //
+////////////////////////////
+
+// Add Target (A File With an Extension Other Than a Source's or an Output's May Be Included)
+void AddTarget(const String& target, bool workspace)
+{
+	Targets.push_back(target);
+	TargetPaths.push_back(NormalizePath(workspace ? InDir(AbsPath("."), target) : target));
+
+	String name = target.substr(target.rfind('/') == String::npos ? 0 : target.rfind('/') + 1);
+	bool   ext  = name.find('.') != String::npos;
+	if (ext && FileExists(target) && !EndsWith(name, ".cpp") && !EndsWith(name, ".o") && !EndsWith(name, ".a") && !EndsWith(name, ".so"))
+	{
+		IncludeTargets = true;
+	}
+}
+
+// Target Names the Output, Its Name, Its Source or One of Its Includes
+bool Targeted(const String& name, const String& output, const String& source, const VecI& includes)
+{
+	if (Targets.empty())
+	{
+		return false;
+	}
+
+	String outputPath = NormalizePath(Qualify(output));
+	String sourcePath = source.empty() ? "" : NormalizePath(Qualify(source));
+
+	bool matched = false;
+	for (int t = 0; t < Targets.size(); t++)
+	{
+		bool match = (!name.empty() && Targets[t] == name) || TargetPaths[t] == outputPath || TargetPaths[t] == sourcePath;
+
+		for (VecI::const_iterator i = includes.begin(); i != includes.end() && !match; ++i)
+		{
+			match = (NormalizePath(PathStr(*i)) == TargetPaths[t]);
+		}
+
+		if (match)
+		{
+			TargetsMatched.insert(Targets[t]);
+			matched = true;
+		}
+	}
+
+	return matched;
+}
+
+// Keep Only Jobs of Selected Outputs and the Jobs They Wait For (Every Target Must Match)
+void SelectJobs(VecJ& jobs)
+{
+	if (Targets.empty())
+	{
+		return;
+	}
+
+	// Every Target Matched
+	for (VecS::iterator t = Targets.begin(); t != Targets.end(); ++t)
+	{
+		if (!TargetsMatched.count(*t))
+		{
+			std::cerr << "No app, unit-test, output, source or include matches target: " << *t << std::endl;
+			Abort();
+		}
+	}
+
+	// Jobs by Output Path Id (-1 When No Job Builds It)
+	VecI outputs(jobs.size());
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		outputs[j] = OutputId(jobs[j]);
+	}
+
+	VecI byOutput(Paths.Size(), -1);
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		byOutput[outputs[j]] = j;
+	}
+
+	// Selected Jobs, Then Those They Wait For
+	std::vector<bool> keep(jobs.size(), false);
+	VecI stack;
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		if (Selected.count(outputs[j]))
+		{
+			keep[j] = true;
+			stack.push_back(j);
+		}
+	}
+
+	while (!stack.empty())
+	{
+		int j = stack.back();
+		stack.pop_back();
+
+		for (VecI::iterator a = jobs[j].after.begin(); a != jobs[j].after.end(); ++a)
+		{
+			int k = byOutput[*a];
+			if (k >= 0 && !keep[k])
+			{
+				keep[k] = true;
+				stack.push_back(k);
+			}
+		}
+	}
+
+	VecJ kept;
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		if (keep[j])
+		{
+			kept.push_back(jobs[j]);
+		}
+	}
+	jobs.swap(kept);
+}
+
+// Report Outputs Depending on the Targets
+void ReportAffected()
+{
+	if (Targets.empty())
+	{
+		std::cerr << "Missing files or targets for affected" << std::endl;
+		Abort();
+	}
+
+	// By Path
+	SetS selected;
+	for (SetI::iterator s = Selected.begin(); s != Selected.end(); ++s)
+	{
+		selected.insert(PathStr(*s));
+	}
+
+	std::cout << Prefix << FgBlu() << "Affected: " << FgOff() << selected.size() << " outputs depend on " << Concat(Targets) << std::endl;
+	for (SetS::iterator s = selected.begin(); s != selected.end(); ++s)
+	{
+		std::cout << Star() << *s << std::endl;
+	}
+}
+
+
+
+////////////////////////////
+// Modules Implementation //
+////////////////////////////
+
+// Scan Module Unit (Declarations at Line Start; module :private and Header Units Ignored)
+const ModuleUnit& GetModuleUnit(int file)
+{
+	std::map<int, ModuleUnit>::iterator find = ModuleUnits.find(file);
+	if (find != ModuleUnits.end())
+	{
+		return find->second;
+	}
+
+	ModuleUnit& unit = ModuleUnits[file];
+	std::ifstream stream(Paths.Path(file));
+
+	String line;
+	while (getline(stream, line))
+	{
+		// [export] module Name; or [export] import Name;
+		VecS tokens = Split(line);
+		int  first  = (!tokens.empty() && tokens[0] == "export") ? 1 : 0;
+		if (tokens.size() < first + 2 || (tokens[first] != "module" && tokens[first] != "import"))
+		{
+			continue;
+		}
+
+		String name = tokens[first + 1];
+		if (EndsWith(name, ";"))
+		{
+			name = ChopEnd(name, 1);
+		}
+		if (name.empty() || name[0] == '<' || name[0] == '"' || name == ":private")
+		{
+			continue;
+		}
+
+		// Module Declared (Implementation Units Import Their Interface)
+		if (tokens[first] == "module")
+		{
+			unit.name      = name;
+			unit.interface = first == 1 || name.find(':') != String::npos;
+			if (!unit.interface)
+			{
+				unit.imports.push_back(name);
+			}
+		}
+		// Module Imported (Partitions Are of the Declared Module)
+		else
+		{
+			if (name[0] == ':')
+			{
+				name = unit.name.substr(0, unit.name.find(':')) + name;
+			}
+			unit.imports.push_back(name);
+		}
+	}
+
+	return unit;
+}
+
+// BMI of a Module (Partition Separator Made a Dash, as GCC Names Them)
+String ModuleBmi(const Project& project, const String& module)
+{
+	String name = module;
+	std::replace(name.begin(), name.end(), ':', '-');
+	return Join(project.bmiDir, name + ".gcm");
+}
+
+// Visit Module Source (Interfaces It Imports First)
+void VisitModuleSource(const String& name, const MapSS& srcByModule, std::map<String, int>& state, const String& objSrcDir, VecS& ordered)
+{
+	if (state[name] == 2)
+	{
+		return;
+	}
+	if (state[name] == 1)
+	{
+		std::cerr << "Module import cycle through: " << Join(objSrcDir, name) << std::endl;
+		Abort();
+	}
+	state[name] = 1;
+
+	const ModuleUnit& unit = GetModuleUnit(PathId(Join(objSrcDir, name)));
+	for (VecS::const_iterator i = unit.imports.begin(); i != unit.imports.end(); ++i)
+	{
+		MapSS::const_iterator find = srcByModule.find(*i);
+		if (find != srcByModule.end() && find->second != name)
+		{
+			VisitModuleSource(find->second, srcByModule, state, objSrcDir, ordered);
+		}
+	}
+
+	state[name] = 2;
+	ordered.push_back(name);
+}
+
+// Find Module Interfaces of the Object Sources (Mapper Written; Sources Returned Interfaces Before Their Importers)
+VecS ScanModules(Project& project, const VecS& objSrcNames)
+{
+	// Interface Sources by Module
+	MapSS srcByModule;
+	for (VecS::const_iterator o = objSrcNames.begin(); o != objSrcNames.end(); ++o)
+	{
+		if (!EndsWith(*o, ".cpp"))
+		{
+			continue;
+		}
+
+		const ModuleUnit& unit = GetModuleUnit(PathId(Join(project.objSrcDir, *o)));
+		if (!unit.interface)
+		{
+			continue;
+		}
+
+		if (srcByModule.count(unit.name))
+		{
+			std::cerr << "Module " << unit.name << " declared by both " << Join(project.objSrcDir, srcByModule[unit.name]) << " and " << Join(project.objSrcDir, *o) << std::endl;
+			Abort();
+		}
+
+		srcByModule[unit.name]         = *o;
+		project.moduleObjs[unit.name] = Join(project.objBinDir, ChopEnd(*o, 4) + ".o");
+	}
+
+	// Module Mapper (Rewritten Only When the Interfaces Change)
+	String mapper;
+	for (MapSS::iterator m = srcByModule.begin(); m != srcByModule.end(); ++m)
+	{
+		mapper += m->first + " " + ModuleBmi(project, m->first) + "\n";
+	}
+
+	String mapperFile = Join(project.bmiDir, "mapper");
+	if (!PlanOnly && ReadFile(mapperFile) != mapper && !WriteFile(mapperFile, mapper))
+	{
+		std::cerr << "Unable to create module mapper: " << mapperFile << std::endl;
+		Abort();
+	}
+
+	// Sources in Import Order
+	VecS ordered;
+	std::map<String, int> state;
+	for (VecS::const_iterator o = objSrcNames.begin(); o != objSrcNames.end(); ++o)
+	{
+		if (EndsWith(*o, ".cpp"))
+		{
+			VisitModuleSource(*o, srcByModule, state, project.objSrcDir, ordered);
+		}
+	}
+
+	return ordered;
+}
+
+// Module Flags, Interface Objects Waited For, and Why the Object Rebuilds (Imported BMI Rebuilt or Newer, Own BMI Missing); False Unless a Module Unit
+bool ModuleDeps(Project& project, const String& srcFile, const String& objFile, String& flags, VecS& after, String& reason)
+{
+	if (!project.modules)
+	{
+		return false;
+	}
+
+	const ModuleUnit& unit = GetModuleUnit(PathId(srcFile));
+	if (unit.name.empty() && unit.imports.empty())
+	{
+		return false;
+	}
+
+	flags = project.moduleFlags;
+
+	// Imported Interfaces
+	for (VecS::const_iterator i = unit.imports.begin(); i != unit.imports.end(); ++i)
+	{
+		MapSS::iterator find = project.moduleObjs.find(*i);
+		if (find == project.moduleObjs.end())
+		{
+			std::cerr << "Module " << *i << " imported by " << srcFile << " has no interface in " << project.objSrcDir << std::endl;
+			Abort();
+		}
+
+		after.push_back(Qualify(find->second));
+
+		String bmi = ModuleBmi(project, *i);
+		if (!reason.empty())
+		{
+			continue;
+		}
+		else if (project.rebuiltModules.count(*i))
+		{
+			reason = "rebuilt input " + bmi;
+		}
+		else if (FileExists(objFile) && GetFileModTm(bmi) > GetFileModTm(objFile))
+		{
+			reason = NewerReason(bmi, objFile);
+		}
+	}
+
+	// Own BMI
+	if (reason.empty() && unit.interface && !FileExists(ModuleBmi(project, unit.name)))
+	{
+		reason = "missing output " + ModuleBmi(project, unit.name);
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////////
+// Build Journal Implementation //
+//////////////////////////////////
+
+// Resume Interrupted Build (Outputs of Jobs Started but Not Finished are Removed, So They Rebuild; Finished Commands are Recorded)
+void ResumeJournal()
+{
+	String path = Join(StateDir, "Journal");
+	std::ifstream stream(path.c_str());
+	if (!stream)
+	{
+		return;
+	}
+
+	// Started, Not Finished
+	SetS unfinished;
+	String line;
+	while (std::getline(stream, line))
+	{
+		std::istringstream fields(line);
+		String entry;
+		String output;
+		if (!(fields >> entry >> output))
+		{
+			continue;
+		}
+
+		if (entry == "start")
+		{
+			unfinished.insert(output);
+			continue;
+		}
+		unfinished.erase(output);
+
+		// Finished Command (History Was Not Saved, So It Would Look Changed)
+		String cmdHash;
+		double wall;
+		if (entry == "done" && fields >> cmdHash >> wall)
+		{
+			RecordCommand(output, cmdHash, wall);
+		}
+	}
+	stream.close();
+
+	// Only Planning (Outputs Planned as Missing, Nothing Removed)
+	if (PlanOnly)
+	{
+		PlannedMissing.insert(unfinished.begin(), unfinished.end());
+		return;
+	}
+
+	// Remove Their Outputs (And Temporaries and Split Debug Info)
+	for (SetS::iterator u = unfinished.begin(); u != unfinished.end(); ++u)
+	{
+		unlink(u->c_str());
+		unlink(TempFile(*u).c_str());
+		if (EndsWith(*u, ".o"))
+		{
+			unlink(DwoFile(*u).c_str());
+		}
+	}
+
+	SaveHistory();
+
+	if (!unfinished.empty())
+	{
+		std::cout << Prefix << FgBlu() << "Resuming: " << FgOff() << unfinished.size() << " interrupted jobs, their outputs removed" << std::endl;
+		InvalidateStats();
+	}
+
+	unlink(path.c_str());
+}
+
+// Open Journal (Appended; Entries Survive the Process, Not a Machine Crash)
+void OpenJournal()
+{
+	MkDir(StateDir);
+	JournalFd = open(Join(StateDir, "Journal").c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+}
+
+// Append Journal Entry (start, done or fail, the Qualified Output and Any Detail)
+void Journal(const String& entry, const String& output, const String& detail)
+{
+	if (JournalFd < 0)
+	{
+		return;
+	}
+
+	String line = entry + " " + output + (detail.empty() ? "" : " " + detail) + "\n";
+	if (write(JournalFd, line.c_str(), line.size()) != (ssize_t)line.size())
+	{
+		std::cerr << "Unable to write build journal in " << StateDir << std::endl;
+	}
+}
+
+// Close and Remove Journal (Every Job Finished)
+void CloseJournal()
+{
+	if (JournalFd < 0)
+	{
+		return;
+	}
+
+	close(JournalFd);
+	JournalFd = -1;
+	unlink(Join(StateDir, "Journal").c_str());
+}
+
+// Temporary Beside an Output (Objects' Replaces the Extension, So Files Compilers Name After It, .dwo and Clang Traces, Come Out as for the Object)
+String TempFile(const String& output)
+{
+	return EndsWith(output, ".o") ? ChopEnd(output, 2) + ".tmp" : output + ".tmp";
+}
+
+// Command Writing a Temporary Beside the Output (Named in temp; Command Unchanged, temp Empty, When It Names No Output)
+String AtomicCmd(const Job& job, String& temp)
+{
+	temp.clear();
+
+	// Output Flag of Compilers, Linkers and Packagers, or of the Archiver
+	const char* flags[] = { " -o ", " rcs " };
+	for (int f = 0; f < 2; f++)
+	{
+		String flag = flags[f] + job.output;
+		size_t at   = job.cmd.find(flag);
+		size_t end  = at + flag.size();
+		if (at != String::npos && (end == job.cmd.size() || job.cmd[end] == ' '))
+		{
+			temp = TempFile(job.output);
+			return job.cmd.substr(0, at) + flags[f] + temp + job.cmd.substr(end);
+		}
+	}
+
+	return job.cmd;
+}
+
+// Run Job Command, Renaming Its Temporary Output Into Place on Success (Returns Exit Code)
+int RunAtomic(const Job& job)
+{
+	String temp;
+	int rc = System(AtomicCmd(job, temp) + job.extra);
+
+	if (!temp.empty())
+	{
+		if (rc == 0 && rename(temp.c_str(), job.output.c_str()) != 0)
+		{
+			rc = 1;
+		}
+		if (rc != 0)
+		{
+			unlink(temp.c_str());
+		}
+	}
+
+	return rc;
+}
+
+
+/////////////////////////////////
+// Remote Cache Implementation //
+/////////////////////////////////
+
+// Remote Cache (Spec is [http://]host[:port][/path], Policy is read, write or readwrite)
+RemoteCache::RemoteCache(const String& spec, const String& policy)
+{
+	String address = spec;
+	if (address.compare(0, 7, "http://") == 0)
+	{
+		address = address.substr(7);
+	}
+
+	// Path
+	size_t slash = address.find('/');
+	if (slash != String::npos)
+	{
+		path = address.substr(slash);
+		address = address.substr(0, slash);
+		while (!path.empty() && path[path.size() - 1] == '/')
+		{
+			path = ChopEnd(path, 1);
+		}
+	}
+
+	// Port
+	size_t colon = address.find(':');
+	if (colon != String::npos)
+	{
+		port = address.substr(colon + 1);
+		address = address.substr(0, colon);
+	}
+	else
+	{
+		port = CachePort;
+	}
+
+	host = address;
+
+	if (host.empty())
+	{
+		std::cerr << "Bad format for cache, must be of the form '[http://]host[:port][/path]' not " << spec << std::endl;
+		Abort();
+	}
+
+	// Policy
+	if (policy != "read" && policy != "write" && policy != "readwrite")
+	{
+		std::cerr << "Bad value for cachepolicy, must be 'read', 'write' or 'readwrite' not " << policy << std::endl;
+		Abort();
+	}
+
+	read  = policy != "write";
+	write = policy != "read";
+}
+
+int RemoteCache::Get(const String& key, const String& file, mode_t mode)
+{
+	String body;
+	int status = CacheHttp(*this, "GET", key, "", body);
+	if (status != 200)
+	{
+		return status < 0 ? -1 : 0;
+	}
+
+	// Written Aside, Then Renamed
+	String temp = file + ".tmp";
+	if (!WriteFile(temp, body) || chmod(temp.c_str(), mode) != 0 || rename(temp.c_str(), file.c_str()) != 0)
+	{
+		unlink(temp.c_str());
+		return 0;
+	}
+
+	return 1;
+}
+
+bool RemoteCache::Put(const String& key, const String& file)
+{
+	String response;
+	int status = CacheHttp(*this, "PUT", key, ReadFile(file), response);
+	return status >= 200 && status < 300;
+}
+
+// Compiler Identity (Hash of Its Version Output, Once per Compiler)
+String CompilerId(const String& compiler)
+{
+	static MapSS ids;
+
+	MapSS::iterator find = ids.find(compiler);
+	if (find != ids.end())
+	{
+		return find->second;
+	}
+
+	return ids[compiler] = Hash(Capture(compiler + " --version 2>&1"));
+}
+
+// Make Job Cacheable When a Cache is Used (Keyed by Compiler Identity, Command, and Contents of Inputs and Includes)
+void CacheJob(Job& job, const String& compiler, const VecS& inputs, const VecI& includes)
+{
+	if (!Cache)
+	{
+		return;
+	}
+
+	job.cacheBase = CompilerId(compiler) + " " + job.cmd;
+	job.inputs    = inputs;
+	for (VecI::const_iterator i = includes.begin(); i != includes.end(); ++i)
+	{
+		job.inputs.push_back(PathStr(*i));
+	}
+}
+
+// Cache Key of a Job (Contents Hashed When the Job Runs, Its Inputs are Built by Then)
+String CacheKey(const Job& job)
+{
+	String data = job.cacheBase;
+	for (VecS::const_iterator i = job.inputs.begin(); i != job.inputs.end(); ++i)
+	{
+		data += " " + HashFile(*i);
+	}
+
+	return Hash(data);
+}
+
+// Run Job Through the Cache (Fetched on a Hit, Stored After Building on a Miss)
+int CacheRun(Executor* exec, const Job& job, int slot)
+{
+	if (!Cache || job.cacheBase.empty())
+	{
+		return exec->Run(job, slot);
+	}
+
+	String key = CacheKey(job);
+
+	// Hit
+	if (Cache->read && Cache->Get(key, job.output, job.kind == JobLink ? 0755 : 0644) == 1)
+	{
+		std::cout << Prefix << FgGrn() << "Cached: " << FgOff() << job.output << std::endl;
+		return 0;
+	}
+
+	// Miss (Stored Once Built)
+	int rc = exec->Run(job, slot);
+	if (rc == 0 && Cache->write)
+	{
+		Cache->Put(key, job.output);
+	}
+
+	return rc;
+}
+
+// Probe the Cache, Then Fetch Outputs of Ready Jobs in Parallel Before Scheduling (Fetched Jobs are Dropped)
+void Prefetch(VecJ& jobs, int nFetch)
+{
+	if (!Cache || jobs.empty())
+	{
+		return;
+	}
+
+	// Reachable (Else Every Job Would Wait Out Its Timeout)
+	int probe = Connect(Cache->host, Cache->port, CacheTimeout);
+	if (probe < 0)
+	{
+		std::cerr << Prefix << FgYlw() << "Cache unreachable, building without it: " << FgOff() << Cache->host << ":" << Cache->port << std::endl;
+		delete Cache;
+		Cache = 0;
+		return;
+	}
+	close(probe);
+
+	if (!Cache->read)
+	{
+		return;
+	}
+
+	// Inputs Being Built, and the Jobs Waiting on Each
+	VecI waiting;
+	std::vector<VecI> dependents;
+	JobGraph(jobs, waiting, dependents);
+
+	// Ready Cacheable Jobs (No Input Being Built)
+	VecI ready;
+	for (int j = 0; j < jobs.size(); j++)
+	{
+		if (!jobs[j].cacheBase.empty() && waiting[j] == 0)
+		{
+			ready.push_back(j);
+		}
+	}
+
+	// Fetch in Parallel (Child Exits 0 on a Hit, 1 on a Miss, 2 When Unreachable)
+	std::map<int, int> fetching;
+	std::vector<bool> fetched(jobs.size(), false);
+	bool unreachable = false;
+	int next = 0;
+
+	while ((next < ready.size() && !unreachable) || !fetching.empty())
+	{
+		// Start Fetches
+		while (next < ready.size() && !unreachable && fetching.size() < nFetch)
+		{
+			const Job& job = jobs[ready[next]];
+			int pid = fork();
+
+			// Error
+			if (pid < 0)
+			{
+				std::cerr << "Failed to fork()" << std::endl;
+				Abort();
+			}
+			// Child
+			else if (pid == 0)
+			{
+				if (!job.dir.empty() && chdir(job.dir.c_str()) != 0)
+				{
+					_exit(1);
+				}
+
+				int hit = Cache->Get(CacheKey(job), job.output, job.kind == JobLink ? 0755 : 0644);
+				_exit(hit == 1 ? 0 : (hit == 0 ? 1 : 2));
+			}
+
+			fetching[pid] = ready[next++];
+		}
+
+		// Wait for a Fetch
+		int status;
+		int pid = wait(&status);
+		if (pid < 0)
+		{
+			break;
+		}
+
+		std::map<int, int>::iterator find = fetching.find(pid);
+		if (find == fetching.end())
+		{
+			continue;
+		}
+
+		int code = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+		const Job& job = jobs[find->second];
 
-	for (VecS::const_iterator s = vecS.begin(); s != vecS.end(); ++s)
-	{
-		if (s != vecS.begin())
+		// Hit (Command Recorded, So It Doesn't Look Changed Next Run)
+		if (code == 0)
 		{
-			result += " ";
+			std::cout << Prefix << FgGrn() << "Cached: " << FgOff() << job.output << std::endl;
+			RecordCommand(InDir(job.dir, job.output), Hash(job.cmd), 0);
+			fetched[find->second] = true;
+			CacheHits++;
 		}
 
-		result += *s;
+		unreachable = unreachable || code == 2;
+		fetching.erase(find);
 	}
 
-	return result;
+	// Lost Mid-Run
+	if (unreachable)
+	{
+		std::cerr << Prefix << FgYlw() << "Cache unreachable, building without it: " << FgOff() << Cache->host << ":" << Cache->port << std::endl;
+		delete Cache;
+		Cache = 0;
+	}
+
+	// Drop Fetched Jobs (Jobs Waiting on Them Find Their Inputs Ready, and Changed)
+	if (CacheHits > 0)
+	{
+		for (int j = 0; j < jobs.size(); j++)
+		{
+			if (fetched[j])
+			{
+				for (VecI::iterator d = dependents[j].begin(); d != dependents[j].end(); ++d)
+				{
+					jobs[*d].cutoff = false;
+				}
+			}
+		}
+
+		VecJ rest;
+		for (int j = 0; j < jobs.size(); j++)
+		{
+			if (!fetched[j])
+			{
+				rest.push_back(jobs[j]);
+			}
+		}
+		jobs.swap(rest);
+
+		SaveHistory();
+		InvalidateStats();
+	}
 }
 
-// Concatenate SetS
-String Concat(const SetS& setS)
+// HTTP Exchange With the Cache (Returns Status, -1 When Unreachable; Body of a Successful GET in response)
+int CacheHttp(const RemoteCache& cache, const String& method, const String& key, const String& body, String& response)
 {
-	String result;
+	response.clear();
 
-	for (SetS::const_iterator s = setS.begin(); s != setS.end(); ++s)
+	int fd = Connect(cache.host, cache.port, CacheTimeout);
+	if (fd < 0)
 	{
-		if (s != setS.begin())
+		return -1;
+	}
+
+	// Request (HTTP/1.0, One Per Connection)
+	std::ostringstream request;
+	request << method << " " << cache.path << "/" << key << " HTTP/1.0\r\n"
+			<< "Host: " << cache.host << ":" << cache.port << "\r\n"
+			<< "Content-Length: " << body.size() << "\r\n"
+			<< "\r\n" << body;
+
+	// Status Line (HTTP/1.x Status Reason)
+	String line;
+	int status = -1;
+	if (SendAll(fd, request.str()) && RecvLine(fd, line))
+	{
+		VecS tokens = Split(line);
+		if (tokens.size() >= 2 && tokens[0].compare(0, 5, "HTTP/") == 0)
 		{
-			result += " ";
+			status = atoi(tokens[1].c_str());
 		}
+	}
 
-		result += *s;
+	// Headers (Content Length)
+	bool   hasLength = false;
+	size_t length    = 0;
+	while (status >= 0)
+	{
+		if (!RecvLine(fd, line))
+		{
+			status = -1;
+			break;
+		}
+
+		if (line.empty() || line == "\r")
+		{
+			break;
+		}
+
+		String name = line.substr(0, line.find(':'));
+		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+		if (name == "content-length")
+		{
+			hasLength = ParseLength(line.substr(name.size() + 1), MaxMessage, length);
+		}
 	}
 
-	return result;
+	// Body of a Hit
+	if (status == 200 && method == "GET" && (!hasLength || !RecvAll(fd, response, length)))
+	{
+		status = -1;
+	}
+
+	close(fd);
+	return status;
 }
 
-// Split
-VecS Split(const String& line)
+// Serve One Cache Request (GET and PUT of Keys Made of Letters, Digits, '-', '_' and '/')
+void ServeCache(int fd)
 {
-	VecS result;
-	std::stringstream stream(line);
+	// Request Line
+	String line;
+	if (!RecvLine(fd, line))
+	{
+		return;
+	}
 
-	String token;
-	while (stream >> token)
+	VecS tokens = Split(line);
+	if (tokens.size() != 3)
 	{
-		result.push_back(token);
+		return;
 	}
 
-	return result;
-}
+	const String& method = tokens[0];
+	const String& key    = tokens[1];
 
-// Display SetS
-String ToStr(const SetS& setS)
-{
-	String result = "Set:";
+	// Headers (Content Length; Absent, Malformed or Above the Largest Stored Output Refuses a Store)
+	bool   hasLength = false;
+	bool   badLength = false;
+	size_t length    = 0;
+	while (RecvLine(fd, line) && !line.empty() && line != "\r")
+	{
+		String name = line.substr(0, line.find(':'));
+		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+		if (name == "content-length")
+		{
+			hasLength = true;
+			badLength = !ParseLength(line.substr(name.size() + 1), MaxMessage, length);
+		}
+	}
 
-	for (SetS::const_iterator s = setS.begin(); s != setS.end(); ++s)
+	// Stored File (Flattened Key)
+	bool valid = key.size() > 1 && key[0] == '/';
+	for (size_t c = 1; c < key.size() && valid; c++)
 	{
-		result += " " + *s;
+		valid = isalnum((unsigned char)key[c]) || key[c] == '-' || key[c] == '_' || key[c] == '/';
 	}
+	String file = Join(CacheStore, FlatName(key.substr(1)));
 
-	return result;
-}
+	String status = "400 Bad Request";
+	String body;
 
-// Ends-With
-bool EndsWith(const String& str, const String& ending)
-{
-	if (str.size() >= ending.size())
+	// Fetch
+	if (valid && method == "GET")
 	{
-		if (str.substr(str.size() - ending.size(), ending.size()) == ending)
+		status = FileExists(file) ? "200 OK" : "404 Not Found";
+		body   = FileExists(file) ? ReadFile(file) : "";
+	}
+	// Store (Written Aside, Then Renamed; Concurrent Stores of a Key Write the Same Content)
+	else if (valid && method == "PUT" && !hasLength)
+	{
+		status = "411 Length Required";
+	}
+	else if (valid && method == "PUT" && badLength)
+	{
+		status = "400 Bad Request";
+	}
+	else if (valid && method == "PUT" && length > CacheMaxSize)
+	{
+		status = "413 Payload Too Large";
+	}
+	else if (valid && method == "PUT")
+	{
+		String data;
+		std::ostringstream temp;
+		temp << file << "." << getpid() << ".tmp";
+
+		status = "500 Internal Server Error";
+		if (RecvAll(fd, data, length) && WriteFile(temp.str(), data) && rename(temp.str().c_str(), file.c_str()) == 0)
 		{
-			return true;
+			status = "201 Created";
 		}
+		unlink(temp.str().c_str());
+	}
+	else if (valid)
+	{
+		status = "405 Method Not Allowed";
 	}
 
-	return false;
+	std::cout << Prefix << method << " " << key << ": " << status << std::endl;
+
+	// Response
+	std::ostringstream response;
+	response << "HTTP/1.0 " << status << "\r\n"
+			 << "Content-Length: " << body.size() << "\r\n"
+			 << "Connection: close\r\n"
+			 << "\r\n" << body;
+	SendAll(fd, response.str());
 }
 
-// File-Exists
-bool FileExists(const String& path)
+// Run Cache Server
+void RunCacheServer(const String& bindAddr, const String& port, int nSlots)
 {
-	struct stat s;
+	Prefix = FgSky() + "* Bake-Cache: " + FgOff();
 
-	if (stat(path.c_str(), &s) == 0)
+	MkDir(CacheStore);
+	int fd = Listen(bindAddr, port);
+	std::cout << Prefix << "Listening on " << bindAddr << ":" << port << " with " << nSlots << " slots, storing up to " << CacheMaxSize / (1024 * 1024) << " MB per output in " << CacheStore << std::endl;
+	if (!IsLoopback(bindAddr))
 	{
-		if (s.st_mode & S_IFREG)
-		{
-			return true;
-		}
+		std::cerr << Prefix << FgYlw() << "Warning: " << FgOff() << "listening on a non-loopback address, any host reaching " << bindAddr << ":" << port << " can read and store outputs unauthenticated" << std::endl;
 	}
 
-	return false;
+	ServeLoop(fd, nSlots, ServeCache);
 }
 
-// File Modification Date
-int GetFileModTm(const String& filename)
+
+
+///////////////////////////////
+// Build File Implementation //
+///////////////////////////////
+
+// Output Missing (Always When Generating a Build File, and When Planned as Missing)
+bool Missing(const String& output)
+{
+	return !GenMode.empty() || PlannedMissing.count(Qualify(output)) || !FileExists(output);
+}
+
+// Escape Path for a ninja Build Line ($, Space and Colon)
+String NinjaPath(const String& path)
 {
-	if (FileExists(filename))
+	String escaped;
+	for (int c = 0; c < path.size(); c++)
 	{
-		struct stat s;
-		if (stat(filename.c_str(), &s) == 0)
+		if (path[c] == '$' || path[c] == ' ' || path[c] == ':')
 		{
-			return s.st_mtime;
+			escaped += '$';
 		}
+		escaped += path[c];
 	}
 
-	return 0;
+	return escaped;
 }
 
-// File Modification Date
-int GetFileModTm(const SetS& filenames)
+// Escape Paths for a ninja Build Line
+String NinjaPaths(const VecS& paths)
 {
-	int result = 0;
-	for (SetS::const_iterator f = filenames.begin(); f != filenames.end(); ++f)
+	String escaped;
+	for (VecS::const_iterator p = paths.begin(); p != paths.end(); ++p)
 	{
-		int modTime = GetFileModTm(*f);
-		if (modTime > result)
-		{
-			result = modTime;
-		}
+		escaped += " " + NinjaPath(*p);
 	}
-	return result;
+
+	return escaped;
 }
 
-// Is Option On
-bool IsOn(const String& key)
+// Escape Value of a ninja Variable ($)
+String NinjaValue(const String& value)
 {
-	for (int a = 0; a < args.size(); a++)
+	String escaped;
+	for (int c = 0; c < value.size(); c++)
 	{
-		if (args[a] == "-" + key)
+		if (value[c] == '$')
 		{
-			return true;
+			escaped += '$';
 		}
+		escaped += value[c];
 	}
 
-	return false;
+	return escaped;
 }
 
-// Has Option
-bool HasOpt(const String& key)
+// Write build.ninja in the Top Directory From the Jobs of Every Project (Rewritten Only When Its Content Changes)
+void GenerateNinja(const String& top, VecP& projects, const VecJ& jobs)
 {
-	for (int a = 0; a < args.size(); a++)
+	// Regenerate Command (This bake, Same Arguments, From the Top Directory)
+	char self[PATH_MAX];
+	ssize_t selfSize = readlink("/proc/self/exe", self, sizeof(self) - 1);
+	String regenCmd = "cd " + top + " && " + (selfSize > 0 ? String(self, selfSize) : String("bake"));
+	for (VecS::iterator a = args.begin(); a != args.end(); ++a)
 	{
-		String arg = args[a];
-		if (arg.size() > 1 + key.size() + 1)
+		regenCmd += " " + *a;
+	}
+
+	// Regenerate Inputs (Workspace, Recipes, and Source Directories for Added or Removed Files)
+	VecS regenInputs;
+	if (HasOpt("workspace"))
+	{
+		regenInputs.push_back(InDir(top, GetOpt("workspace")));
+	}
+
+	// Projects by Directory, Unit-Test Edges and Clean Command
+	std::map<String, Project*> dirProjects;
+	std::ostringstream unitEdges;
+	VecS   unitStamps;
+	String cleanCmd;
+
+	// For Each Project
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
+	{
+		UseProject(*p);
+		dirProjects[p->dir] = &*p;
+
+		String enter = p->dir.empty() ? "" : "cd " + p->dir + " && ";
+
+		// Recipe and Source Directories
+		regenInputs.push_back(InDir(p->dir, p->recipe));
+		regenInputs.push_back(Qualify(p->objSrcDir));
+
+		VecVecS srcDescs  = GetValsM("AppDir");
+		VecVecS unitDescs = GetValsM("UnitTestDir");
+		srcDescs.insert(srcDescs.end(), unitDescs.begin(), unitDescs.end());
+		for (VecVecS::iterator d = srcDescs.begin(); d != srcDescs.end(); ++d)
 		{
-			// Find -key=Value
-			if (arg.substr(0, 1 + key.size() + 1) == "-" + key + "=")
-			{
-				return true;
-			}
+			regenInputs.push_back(Qualify((*d)[0]));
+		}
+
+		// Unit-Tests (Stamped When Passing, So Only Those Whose Binary Changed Run Again)
+		for (int t = 0; t < p->unitCmds.size(); t++)
+		{
+			String unitBinFile = Qualify(Split(p->unitCmds[t])[0].substr(2));
+			String unitStamp   = Qualify(Join(GetVal("ObjectBinDir"), FlatName(p->unitFiles[t]) + ".passed"));
+			unitEdges << "build " << NinjaPath(unitStamp) << ": unittest " << NinjaPath(unitBinFile) << "\n";
+			unitEdges << "  cmd = " << NinjaValue(enter + p->unitCmds[t]) << "\n";
+			unitStamps.push_back(unitStamp);
+		}
+
+		// Clean
+		VecS cleanCmds = CleanCommands();
+		for (VecS::iterator c = cleanCmds.begin(); c != cleanCmds.end(); ++c)
+		{
+			cleanCmd += (cleanCmd.empty() ? "" : " && ") + enter + *c;
 		}
 	}
 
-	return false;
-}
+	std::ostringstream ninja;
+	ninja << "# Generated by bake -gen=ninja, Regenerated When Recipes or Source Directories Change\n";
+	ninja << "ninja_required_version = 1.3\n\n";
 
-// Get Option
-String GetOpt(const String& key)
-{
-	for (int a = 0; a < args.size(); a++)
+	// Rules
+	ninja << "rule regenerate\n  command = $cmd\n  description = Regenerating build.ninja\n  generator = 1\n  restat = 1\n\n";
+	ninja << "rule compile\n  command = $cmd\n  depfile = $out.d\n  deps = gcc\n  description = Compiling $in\n\n";
+	ninja << "rule link\n  command = $cmd\n  description = Linking $out\n\n";
+	ninja << "rule unittest\n  command = $cmd && touch $out\n  description = Testing $in\n\n";
+	ninja << "rule clean\n  command = $cmd\n  description = Cleaning\n\n";
+
+	// Regenerate
+	ninja << "build build.ninja: regenerate |" << NinjaPaths(regenInputs) << "\n";
+	ninja << "  cmd = " << NinjaValue(regenCmd) << "\n\n";
+
+	// For Each Job
+	VecS outputs;
+	for (VecJ::const_iterator j = jobs.begin(); j != jobs.end(); ++j)
 	{
-		String arg = args[a];
-		if (arg.size() > 1 + key.size() + 1)
+		String output = InDir(j->dir, j->output);
+		String enter  = j->dir.empty() ? "" : "cd " + j->dir + " && ";
+		outputs.push_back(output);
+		VecS after = PathStrs(j->after);
+
+		// Compile (Headers From the Depfile, Its Paths Made Absolute When Run in a Project Directory)
+		if (j->kind == JobCompile)
 		{
-			// Find -key=Value
-			if (arg.substr(0, 1 + key.size() + 1) == "-" + key + "=")
+			String depFile = j->output + ".d";
+			String cmd     = enter + j->cmd + " -MMD -MF " + depFile;
+			if (!j->dir.empty())
 			{
-				return arg.substr(1 + key.size() + 1, arg.size() - 1 - key.size() - 1);
+				cmd += " && sed -E -i 's@(^| )([^/ \\\\][^ ]*)@\\1" + j->dir + "/\\2@g' " + depFile;
+			}
+
+			ninja << "build " << NinjaPath(output) << ": compile " << NinjaPath(InDir(j->dir, j->source));
+			if (!j->after.empty())
+			{
+				ninja << " |" << NinjaPaths(after);
+			}
+			ninja << "\n  cmd = " << NinjaValue(cmd) << "\n";
+		}
+		// Link, Archive or Debug Package (Also Waiting on Library Files Linked Against, Not Already Inputs)
+		else
+		{
+			VecS libFiles;
+			Project* project = dirProjects[j->dir];
+			if (!j->background && project)
+			{
+				for (SetS::iterator l = project->libFileNames.begin(); l != project->libFileNames.end(); ++l)
+				{
+					String libFile = InDir(j->dir, *l);
+					if (libFile != output && std::find(after.begin(), after.end(), libFile) == after.end())
+					{
+						libFiles.push_back(libFile);
+					}
+				}
+			}
+
+			ninja << "build " << NinjaPath(output) << ": link" << NinjaPaths(after);
+			if (!libFiles.empty())
+			{
+				ninja << " |" << NinjaPaths(libFiles);
 			}
+			ninja << "\n  cmd = " << NinjaValue(enter + j->cmd) << "\n";
 		}
 	}
+	ninja << "\n" << unitEdges.str() << "\n";
+
+	// Aggregates (Build and Test by Default, Like bake)
+	ninja << "build all: phony" << NinjaPaths(outputs) << "\n";
+	ninja << "build test: phony" << NinjaPaths(unitStamps) << "\n";
+	ninja << "build clean: clean\n  cmd = " << NinjaValue(cleanCmd) << "\n\n";
+	ninja << "default all test\n";
+
+	// Write When Changed (An Unchanged File Keeps Its Time, So ninja Doesn't Reload It)
+	String ninjaFile = Join(top, "build.ninja");
+	String content   = ninja.str();
+	if (FileExists(ninjaFile) && ReadFile(ninjaFile) == content)
+	{
+		std::cout << Prefix << "Unchanged: " << ninjaFile << std::endl;
+		return;
+	}
 
-	std::cerr << "Missing Option: " << key << std::endl;
-	exit(1);
+	if (!WriteFile(ninjaFile, content))
+	{
+		std::cerr << "Unable to write build file: " << ninjaFile << std::endl;
+		Abort();
+	}
+	std::cout << Prefix << "Generated: " << ninjaFile << std::endl;
 }
 
-// Get Value from Recipe
-String GetVal(const String& key)
+
+
+////////////////////////
+// Run Implementation //
+////////////////////////
+
+// Apply Options (Spawn Size, Placement, Priority, Modes, Budgets, Remote Workers and Cache; Returns the Spawn Size)
+int ApplyOptions()
 {
-	for (int i = 0; i < lines.size(); i++)
+	// CPU Topology
+	LoadTopology();
+
+	// Spawn Size (auto is the CPU Limit)
+	int cpus   = GetCpuLimit();
+	int nSpawn = 1;
+	if (HasOpt("j"))
 	{
-		const VecS& tokens = lines[i];
+		nSpawn = (GetOpt("j") == "auto") ? cpus : Max(atoi(GetOpt("j").c_str()), 1);
+	}
 
-		if (tokens[0] == key)
+	// CPU-Limited cgroup or cpuset (Capped, So Jobs Don't Oversubscribe the Quota)
+	if (nSpawn > cpus && cpus < sysconf(_SC_NPROCESSORS_ONLN))
+	{
+		std::cerr << "Limiting -j to " << cpus << " (CPU limit of this cgroup or cpuset)" << std::endl;
+		nSpawn = cpus;
+	}
+
+	// Worker Placement
+	PinMode = HasOpt("pin") ? GetOpt("pin") : PinMode;
+	if (PinMode != "off" && PinMode != "node" && PinMode != "core")
+	{
+		std::cerr << "Bad value for pin, must be 'off', 'node' or 'core' not " << PinMode << std::endl;
+		Abort();
+	}
+
+	// Lower Priority (Background Builds; Embedded, Only Jobs are Lowered, a Host Couldn't Raise Its Own Back)
+	if (IsOn("nice") || HasOpt("nice"))
+	{
+		int nice = HasOpt("nice") ? atoi(GetOpt("nice").c_str()) : 10;
+		if (HostPid)
 		{
-			return tokens[1];
+			JobNice = nice;
+		}
+		else
+		{
+			LowerPriority(nice);
 		}
 	}
 
-	std::cerr << "Can't find key in recipe: " << key << std::endl;
-	exit(1);
-}
+	// Job Order
+	NaiveOrder = IsOn("naive");
 
-// Get Values from Recipe
-VecS GetVals(const String& key)
-{
-	VecS result;
+	// Explain
+	ExplainMode = IsOn("explain");
 
-	for (int i = 0; i < lines.size(); i++)
+	// Compile Analysis
+	AnalyzeMode = IsOn("analyze") ? "size" : (HasOpt("analyze") ? GetOpt("analyze") : "");
+	if (!AnalyzeMode.empty() && AnalyzeMode != "size" && AnalyzeMode != "trace")
 	{
-		const VecS& tokens = lines[i];
+		std::cerr << "Bad value for analyze, must be 'size' or 'trace' not " << AnalyzeMode << std::endl;
+		Abort();
+	}
 
-		if (tokens[0] == key)
-		{
-			for (int r = 1; r < tokens.size(); r++)
-			{
-				result.push_back(tokens[r]);
-			}
-		}
+	// Build File Generator
+	GenMode = HasOpt("gen") ? GetOpt("gen") : "";
+	if (!GenMode.empty() && GenMode != "ninja")
+	{
+		std::cerr << "Bad value for gen, must be 'ninja' not " << GenMode << std::endl;
+		Abort();
 	}
 
-	if (result.empty())
+	// Memory Budget (KB)
+	MemBudget = HasOpt("mem") ? atol(GetOpt("mem").c_str()) * 1024 : GetMemoryBudget();
+
+	// Link and Compile Caps
+	LinkSpawn    = HasOpt("jlink")    ? Max(atoi(GetOpt("jlink").c_str()), 1)    : 0;
+	CompileSpawn = HasOpt("jcompile") ? Max(atoi(GetOpt("jcompile").c_str()), 1) : 0;
+
+	// Remote Workers
+	if (HasOpt("remote"))
 	{
-		std::cerr << "Can't find key in recipe: " << key << std::endl;
-		exit(1);
+		Remote = new RemoteExecutor(GetOpt("remote"));
 	}
 
-	return result;
+	// Remote Cache
+	if (HasOpt("cache"))
+	{
+		Cache = new RemoteCache(GetOpt("cache"), HasOpt("cachepolicy") ? GetOpt("cachepolicy") : "readwrite");
+	}
+
+	return nSpawn;
 }
 
-// Get Multiple Values from Recipe
-VecVecS GetValsM(const String& key)
+// Load Projects (Every Project of a Workspace in Dependency Order, Else the One Recipe)
+void LoadProjects(const String& recipe, VecP& projects)
 {
-	VecVecS result;
+	if (HasOpt("workspace"))
+	{
+		LoadWorkspace(GetOpt("workspace"), projects);
+	}
+	else
+	{
+		Project project;
+		project.recipe = recipe;
+		LoadProject(project);
+		projects.push_back(project);
+
+		UseProject(projects[0]);
+		StateDir = GetValOr("StateDir", StateDir);
+		FingerprintMode = GetValOr("HeaderFingerprints", "off") == "on";
+	}
+}
+
+// Configure Projects (Settings, and the Job Server When LTO Links Take Tokens)
+void ConfigureProjects(VecP& projects, int nSpawn)
+{
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
+	{
+		UseProject(*p);
+
+		// Project Name (Workspace)
+		if (!p->dir.empty())
+		{
+			std::cout << Prefix << std::endl;
+		}
 
-	for (int i = 0; i < lines.size(); i++)
-	{
-		const VecS& tokens = lines[i];
+		ConfigureProject(*p, nSpawn);
 
-		if (tokens[0] == key)
+		// Job Server (GCC Parallel LTO Links Take Tokens From the -j Pool; Not for Planning Only)
+		if (p->ltoLinkFlags.find("jobserver") != String::npos && JobServerFds[1] < 0 && !PlanOnly)
 		{
-			VecS match;
-			for (int r = 1; r < tokens.size(); r++)
-			{
-				match.push_back(tokens[r]);
-			}
-			result.push_back(match);
+			StartJobServer(nSpawn);
 		}
 	}
-
-	return result;
 }
 
-
-// Get Set of Included Files from a File
-SetS GetIncls(const String& file)
+// Collect Jobs of Every Project (One Graph, Links Wait for the Libraries They Use)
+void CollectJobs(VecP& projects, VecJ& jobs, VecJ& ppJobs, VecS& traceFiles)
 {
-	SetS result;
-	std::ifstream stream(file.c_str());
+	// Objects and Object Libraries
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
+	{
+		UseProject(*p);
+		CollectObjects(*p, jobs, ppJobs, traceFiles);
+	}
 
-	if (!stream)
+	// Apps and Unit-Tests
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
 	{
-		return result;
+		UseProject(*p);
+		CollectBinaries(*p, projects, jobs, ppJobs);
 	}
+}
 
-	String line;
-	while (getline(stream, line))
+// Build Jobs, Run Unit-Tests and Record the Run (Returns True When a Project Failed)
+bool BuildJobs(VecP& projects, VecJ& jobs, int nSpawn, double start, SetS& failedOutputs, MapSD& run)
+{
+	// Prefix of the Whole Build
+	String prefix = Prefix;
+
+	// Remove Stale Shared Objects of Static Object Libraries (Linkers Would Prefer Them Over the Archives; Only When Building)
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
 	{
-		if (line.substr(0, 8) == "#include")
+		if (!p->objLibShared && !p->objLibSo.empty() && unlink(InDir(p->dir, p->objLibSo).c_str()) == 0)
 		{
-			VecS tokens = Split(line);
-			if (tokens.size() >= 2)
-			{
-				String include = tokens[1];
-				if (include.size() > 2)
-				{
-					include = include.substr(1, include.size() - 2);
-
-					// Find Exact File (Search Include Directories)
-					for (VecS::iterator i = inclDirs.begin(); i != inclDirs.end(); ++i)
-					{
-						String candidate = Join(*i, include);
-						if (FileExists(candidate))
-						{
-							result.insert(candidate);
-							break;
-						}
-					}
-				}
-			}
+			InvalidateStats();
 		}
 	}
 
-	return result;
-}
+	// Spawn Builds
+	double build = Now();
+	Prefetch(jobs, Max(nSpawn * 4, 8));
+	int nFailed = Spawn(jobs, nSpawn, &failedOutputs);
+	double test = Now();
 
-SetS GetAllIncls(const String& file)
-{
-	// Immediate Includes
-	SetS inclSet = GetIncls(file);
+	// Persist Header Fingerprints
+	if (FingerprintMode)
+	{
+		SaveHeaderPrints();
+	}
 
-	// Ancestral Iteration
-	while (true)
+	// Unit-Tests
+	bool failed = false;
+
+	LoadTestResults();
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
 	{
-		// All Includes
-		SetS nextSet = inclSet;
+		UseProject(*p);
 
-		// For Each Include
-		for (SetS::iterator i = inclSet.begin(); i != inclSet.end(); ++i)
+		// Object Library Failed
+		if (failedOutputs.count(Qualify(p->objLib)))
 		{
-			// Add Ancestors
-			SetS ancestors = GetIncls(*i);
-			for (SetS::iterator a = ancestors.begin(); a != ancestors.end(); ++a)
-			{
-				nextSet.insert(*a);
-			}
+			std::cerr << "Failed to build object library: " << p->objLib << std::endl;
+			p->failed = true;
 		}
 
-		// No Additional Found
-		if (nextSet.size() == inclSet.size())
+		// Library of a Dependency Failed
+		for (VecI::iterator d = p->deps.begin(); d != p->deps.end(); ++d)
 		{
-			break;
+			p->failed = p->failed || projects[*d].failed;
+		}
+
+		if (p->failed)
+		{
+			failed = true;
+			continue;
 		}
-			
-		inclSet = nextSet;
+
+		RunUnitTests(*p);
 	}
-		
-	return inclSet;
+	SaveTestResults();
+
+	Prefix = prefix;
+
+	// Record Run
+	run["when"]     = time(0);
+	run["wall"]     = Now() - start;
+	run["plan"]     = build - start;
+	run["build"]    = test - build;
+	run["test"]     = Now() - test;
+	run["checked"]  = OutputsChecked;
+	run["rebuilt"]  = jobs.size();
+	run["failed"]   = nFailed;
+	run["statHit"]  = StatHits;
+	run["statMiss"] = StatMisses;
+	run["inclHit"]  = InclHits;
+	run["inclScan"] = InclScans;
+	run["testRun"]  = TestsRun;
+	run["testSkip"] = TestsSkipped;
+	run["cacheHit"] = CacheHits;
+	run["cutOff"]   = JobsCutOff;
+	RecordRun(run);
+
+	return failed;
 }
 
-// Make-Directory
-void MkDir(const String& dir)
+
+
+////////////////////////////
+// Library Implementation //
+////////////////////////////
+
+State::State() : statGeneration(1), journalFd(-1),
+	statHits(0), statMisses(0), inclHits(0), inclScans(0), outputsChecked(0), testsRun(0), testsSkipped(0), cacheHits(0), jobsCutOff(0),
+	includeTargets(false), naiveOrder(false), fingerprintMode(false), explainMode(false), memBudget(0), linkSpawn(0), compileSpawn(0),
+	pinMode("off"), remote(0), cache(0), cacheStore("/tmp/bake-cache"), planOnly(false), jobNice(0), jobServerRead(-1)
 {
-	String cmd = "mkdir -p " + dir;
-	int rc = system(cmd.c_str());
+	stateDir = ".bake";
+	jobServerFds[0] = -1;
+	jobServerFds[1] = -1;
 }
 
-// Chop-Ending
-String ChopEnd(const String& str, int end)
+State::~State()
 {
-	if ((int)str.size() <= end)
+	delete remote;
+	delete cache;
+
+	int fds[] = { journalFd, jobServerFds[0], jobServerFds[1], jobServerRead };
+	for (int f = 0; f < 4; f++)
 	{
-		return "";
+		if (fds[f] >= 0)
+		{
+			close(fds[f]);
+		}
 	}
+}
 
-	return str.substr(0, str.size() - end);
+// Swap State With the Globals
+void SwapState(State& state)
+{
+	// Recipe and Project
+	args.swap(state.args);
+	lines.swap(state.lines);
+	variables.swap(state.variables);
+	inclDirs.swap(state.inclDirs);
+	RecipeName.swap(state.recipeName);
+	Prefix.swap(state.prefix);
+	StateDir.swap(state.stateDir);
+	ProjectDir.swap(state.projectDir);
+
+	// Caches
+	SwapCaches(state);
+
+	// History and Results
+	History.swap(state.history);
+	RunStats.swap(state.runStats);
+	TestResults.swap(state.testResults);
+	HeaderPrints.swap(state.headerPrints);
+	ModuleUnits.swap(state.moduleUnits);
+	Reasons.swap(state.reasons);
+	std::swap(JournalFd, state.journalFd);
+
+	// Counters
+	std::swap(StatHits, state.statHits);
+	std::swap(StatMisses, state.statMisses);
+	std::swap(InclHits, state.inclHits);
+	std::swap(InclScans, state.inclScans);
+	std::swap(OutputsChecked, state.outputsChecked);
+	std::swap(TestsRun, state.testsRun);
+	std::swap(TestsSkipped, state.testsSkipped);
+	std::swap(CacheHits, state.cacheHits);
+	std::swap(JobsCutOff, state.jobsCutOff);
+
+	// Targets
+	Targets.swap(state.targets);
+	TargetPaths.swap(state.targetPaths);
+	TargetsMatched.swap(state.targetsMatched);
+	std::swap(IncludeTargets, state.includeTargets);
+	Selected.swap(state.selected);
+
+	// Options
+	std::swap(NaiveOrder, state.naiveOrder);
+	std::swap(FingerprintMode, state.fingerprintMode);
+	std::swap(ExplainMode, state.explainMode);
+	AnalyzeMode.swap(state.analyzeMode);
+	std::swap(MemBudget, state.memBudget);
+	std::swap(LinkSpawn, state.linkSpawn);
+	std::swap(CompileSpawn, state.compileSpawn);
+	CpuNodes.swap(state.cpuNodes);
+	PinMode.swap(state.pinMode);
+	std::swap(Remote, state.remote);
+	std::swap(Cache, state.cache);
+	CacheStore.swap(state.cacheStore);
+	GenMode.swap(state.genMode);
+	std::swap(PlanOnly, state.planOnly);
+	PlannedMissing.swap(state.plannedMissing);
+	std::swap(JobNice, state.jobNice);
+
+	// Job Server
+	std::swap(JobServerFds[0], state.jobServerFds[0]);
+	std::swap(JobServerFds[1], state.jobServerFds[1]);
+	std::swap(JobServerRead, state.jobServerRead);
 }
 
-// Spawn Set of Commands
-void Spawn(const VecS& cmds, int nSpawn)
+// Swap the Caches a Context Keeps Warm (Paths, Stats and Includes) With the Globals
+void SwapCaches(State& state)
 {
-	int c = 0;
-	int alive = 0;
-	MapIS pids;
+	Paths.Swap(state.paths);
+	std::swap(StatGeneration, state.statGeneration);
+	InclResolved.swap(state.inclResolved);
+	InclContexts.swap(state.inclContexts);
+	InclContextKey.swap(state.inclContextKey);
+}
+
+// Forget Stats, and the Includes of Files Changed Since the Last Call (Names are Resolved Afresh)
+void RefreshPaths()
+{
+	std::vector<int> before = Paths.modTm;
+	InvalidateStats();
+
+	// Names May Resolve Elsewhere Now
+	InclResolved.clear();
+	for (std::map<String, InclContext>::iterator c = InclContexts.begin(); c != InclContexts.end(); ++c)
+	{
+		c->second.resolved.clear();
+	}
 
-	while (c < cmds.size())
+	for (int id = 0; id < Paths.Size(); id++)
 	{
-		// At Spawn Capacity
-		while (alive >= nSpawn)
+		StatPath(id);
+		if (Paths.modTm[id] == before[id])
 		{
-			int status;
+			continue;
+		}
 
-			// Wait for Process to Finish
-			int pid = wait(&status);
+		// Rescanned in the Current Context
+		Paths.scanned[id] = false;
+		Paths.incls[id].clear();
 
-			// Known Process
-			if (pids.find(pid) != pids.end())
+		// And in the Others
+		for (std::map<String, InclContext>::iterator c = InclContexts.begin(); c != InclContexts.end(); ++c)
+		{
+			if (c->first != InclContextKey && id < c->second.scanned.size())
 			{
-				// Abnormal Termination
-				if (!WIFEXITED(status))
-				{
-					std::cerr << Prefix
-							  << FgRed() << "Execution Failed: " << FgOff()
-							  << FgYlw() << pids[pid] << FgOff() << std::endl;
-					exit(1);
-				}
-
-				pids.erase(pid);
-				alive--;
+				c->second.scanned[id] = false;
+				c->second.incls[id].clear();
 			}
 		}
+	}
+}
 
-		// Next Command
-		const String& cmd = cmds[c];
+// Output Captured So Far by the Current Call (Read Without Moving the Shared Offset)
+String CapturedLog()
+{
+	String log;
 
-		// Fork and Execute
-		int pid = fork();
+	struct stat s;
+	if (LogFd < 0 || fstat(LogFd, &s) != 0)
+	{
+		return log;
+	}
 
-		// Error
-		if (pid < 0)
-		{
-			std::cerr << "Failed to fork()" << std::endl;
-			exit(1);
-		}
-		// Child
-		else if (pid == 0)
+	log.resize(s.st_size);
+	ssize_t size = s.st_size > 0 ? pread(LogFd, &log[0], s.st_size, 0) : 0;
+	log.resize(size > 0 ? size : 0);
+
+	return log;
+}
+
+// Call of a Context (Enters Its Directory, Captures Output, Swaps Its State In; Undone on Return or Throw)
+Call::Call(bake::Context::Impl& context) : context(context)
+{
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(0);
+
+	// Directory
+	cwd = open(".", O_RDONLY);
+	if (cwd < 0 || chdir(context.dir.c_str()) != 0)
+	{
+		if (cwd >= 0)
 		{
-			std::cout << Prefix << FgGrn() << "Executing: " << FgOff() << cmd << std::endl;
-			system(cmd.c_str());
-			exit(0);
+			close(cwd);
 		}
-		// Parent
-		else
+		throw bake::Error("Can't enter directory: " + context.dir);
+	}
+
+	// Captured Output
+	char path[] = "/tmp/bake-log-XXXXXX";
+	log = mkstemp(path);
+	if (log < 0)
+	{
+		if (fchdir(cwd) != 0)
 		{
-			pids[pid] = cmd;
-			alive++;
+			std::cerr << "Can't return to the directory before the call" << std::endl;
 		}
+		close(cwd);
+		throw bake::Error("Can't create output log in /tmp");
+	}
+	unlink(path);
+
+	out = dup(1);
+	err = dup(2);
+	dup2(log, 1);
+	dup2(log, 2);
 
-		// Next Command
-		c++;
+	LogFd   = log;
+	HostPid = getpid();
+
+	const char* hostMakeflags = getenv("MAKEFLAGS");
+	hadMakeflags = hostMakeflags != 0;
+	makeflags    = hadMakeflags ? hostMakeflags : "";
+
+	// Fresh Globals, With the Context's Caches
+	SwapState(saved);
+	SwapCaches(context.caches);
+	RefreshPaths();
+
+	// Options as Arguments
+	const bake::Options& options = context.options;
+	args.push_back("-r=" + (options.recipe.empty() ? String("Recipe.cfg") : options.recipe));
+	if (!options.workspace.empty())
+	{
+		args.push_back("-workspace=" + options.workspace);
 	}
 
-	// Finish Remaining
-	while (alive > 0)
+	std::ostringstream jobs;
+	jobs << "-j=";
+	if (options.jobs > 0)
 	{
-		int status;
+		jobs << options.jobs;
+	}
+	else
+	{
+		jobs << "auto";
+	}
+	args.push_back(jobs.str());
 
-		// Wait for Process to Finish
-		int pid = wait(&status);
+	for (VecS::const_iterator f = options.flags.begin(); f != options.flags.end(); ++f)
+	{
+		args.push_back("-" + *f);
+	}
+}
 
-		// Known Process
-		if (pids.find(pid) != pids.end())
-		{
-			// Abnormal Termination
-			if (!WIFEXITED(status))
-			{
-				std::cerr << Prefix << FgRed() << "Execution Failed: " << FgOff() << pids[pid] << std::endl;
-				exit(1);
-			}
+Call::~Call()
+{
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(0);
 
-			pids.erase(pid);
-			alive--;
-		}
+	// Caches Back to the Context, Globals as Before
+	SwapCaches(context.caches);
+	SwapState(saved);
+
+	HostPid = 0;
+	LogFd   = -1;
+
+	if (hadMakeflags)
+	{
+		setenv("MAKEFLAGS", makeflags.c_str(), 1);
+	}
+	else
+	{
+		unsetenv("MAKEFLAGS");
+	}
+
+	// Output
+	dup2(out, 1);
+	dup2(err, 2);
+	close(out);
+	close(err);
+	close(log);
+
+	// Directory
+	if (fchdir(cwd) != 0)
+	{
+		std::cerr << "Can't return to the directory before the call" << std::endl;
 	}
+	close(cwd);
 }
 
-// List Files in a Directory
-VecS ListFiles(const String& dir)
+// Plan Jobs of a Call (Options, Targets, Projects, History, Settings, Jobs of the Selected Outputs; Returns the Spawn Size)
+int PlanCall(const VecS& targets, VecP& projects, VecJ& jobs)
 {
-	VecS result;
-
-	// Open Directory
-	DIR* d = opendir(dir.c_str());
-	dirent *ent;
+	int nSpawn = ApplyOptions();
 
-	// Directory Does Not Exist
-	if (!d)
+	// Targets
+	for (VecS::const_iterator t = targets.begin(); t != targets.end(); ++t)
 	{
-		return result;
+		AddTarget(*t, HasOpt("workspace"));
 	}
 
-	// For Each Entry
-	while (ent = readdir(d))
+	// Projects, History and Settings
+	LoadProjects(GetOpt("r"), projects);
+	LoadHistory();
+
+	FingerprintMode = FingerprintMode || IsOn("fingerprint");
+	if (FingerprintMode)
 	{
-		String filename = ent->d_name;
-		String fullPath = Join(dir, filename);
+		LoadHeaderPrints();
+	}
 
-		// Empty Filename
-		if (filename.empty())
-		{
-			continue;
-		}
+	ResumeJournal();
+	ConfigureProjects(projects, nSpawn);
 
-		// Exclude Self
-		if (filename[0] == '.')
-		{
-			continue;
-		}
+	// Jobs
+	VecJ ppJobs;
+	VecS traceFiles;
+	CollectJobs(projects, jobs, ppJobs, traceFiles);
+	SelectJobs(jobs);
 
-		// Get File Info
-		// Get File Info
-		struct stat st;
-		if (stat(fullPath.c_str(), &st) == -1)
-		{
-			continue;
-		}
+	return nSpawn;
+}
 
-		// Not A File
-		if (st.st_mode & S_IFDIR == 0)
+// Jobs as the Library Describes Them
+std::vector<bake::Job> ApiJobs(const VecJ& jobs)
+{
+	std::vector<bake::Job> result;
+
+	for (VecJ::const_iterator j = jobs.begin(); j != jobs.end(); ++j)
+	{
+		bake::Job job;
+		job.output  = InDir(j->dir, j->output);
+		job.source  = j->source;
+		job.command = j->cmd;
+		job.kind    = (j->kind == JobCompile) ? "compile" : "link";
+		job.dir     = j->dir;
+		job.after   = PathStrs(j->after);
+
+		MapSS::iterator reason = Reasons.find(job.output);
+		if (reason != Reasons.end())
 		{
-			continue;
+			job.reason = reason->second;
 		}
 
-		// Add File
-		result.push_back(filename);
+		result.push_back(job);
 	}
 
-	closedir(d);
 	return result;
 }
 
-// System Call
-int System(const String& cmd)
+// Context
+bake::Context::Context(const std::string& dir, const Options& options) : impl(new Impl)
 {
-	return system(cmd.c_str());
+	impl->dir     = AbsPath(dir);
+	impl->options = options;
 }
 
-// Get All Library Files
-SetS GetLibFiles()
+bake::Context::~Context()
 {
-	SetS result;
+	delete impl;
+}
 
-	VecS libPaths = GetVals("LibraryDirs");
-	VecS libNames = GetVals("Libraries");
+// Load Recipes (Every Project of a Workspace in Dependency Order, Else the One Recipe)
+std::vector<bake::Recipe> bake::Context::Recipes()
+{
+	Call call(*impl);
 
-	for (VecS::iterator p = libPaths.begin(); p != libPaths.end(); ++p)
+	VecP projects;
+	LoadProjects(GetOpt("r"), projects);
+
+	std::vector<bake::Recipe> recipes;
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
 	{
-		for (VecS::iterator n = libNames.begin(); n != libNames.end(); ++n)
+		bake::Recipe recipe;
+		recipe.name        = p->name;
+		recipe.dir         = p->dir;
+		recipe.file        = p->recipe;
+		recipe.lines       = p->lines;
+		recipe.variables   = p->variables;
+		recipe.includeDirs = p->inclDirs;
+
+		for (VecI::iterator d = p->deps.begin(); d != p->deps.end(); ++d)
 		{
-			String sharedObj = Join(*p, "lib" + *n + ".so");
-			String staticArc = Join(*p, "lib" + *n + ".a");
+			recipe.deps.push_back(projects[*d].name);
+		}
 
-			if (FileExists(sharedObj))
-			{
-				result.insert(sharedObj);
-			}
+		recipes.push_back(recipe);
+	}
 
-			if (FileExists(staticArc))
-			{
-				result.insert(staticArc);
-			}
+	return recipes;
+}
+
+// Include Closure of a Source or Header (Resolved by the Project Whose Directory Holds It, Else the First)
+std::vector<std::string> bake::Context::Includes(const std::string& file)
+{
+	Call call(*impl);
+
+	String path = impl->options.workspace.empty() ? file : AbsPath(file);
+
+	VecP projects;
+	LoadProjects(GetOpt("r"), projects);
+
+	Project* project = &projects[0];
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
+	{
+		if (!p->dir.empty() && path.compare(0, p->dir.size() + 1, p->dir + "/") == 0)
+		{
+			project = &*p;
 		}
 	}
+	UseProject(*project);
+
+	VecI includes;
+	GetAllIncls(PathId(path), includes);
+
+	std::vector<std::string> result;
+	for (VecI::iterator i = includes.begin(); i != includes.end(); ++i)
+	{
+		result.push_back(PathStr(*i));
+	}
 
 	return result;
 }
 
-String FgOn(int color)
+// Jobs That Would Run, and Why (Only Those of the Targets and Their Inputs, When Given)
+std::vector<bake::Job> bake::Context::Plan(const std::vector<std::string>& targets)
 {
-	char buffer[20];
-	sprintf(buffer, "%c[38;5;%dm", 0x1B, color);
-	return buffer;
+	Call call(*impl);
+	PlanOnly = true;
+
+	VecP projects;
+	VecJ jobs;
+	PlanCall(targets, projects, jobs);
+
+	return ApiJobs(jobs);
 }
 
-String FgOff()
+// Build and Run Unit-Tests (Only the Targets and Their Inputs, When Given)
+bake::Result bake::Context::Build(const std::vector<std::string>& targets)
 {
-	char buffer[20];
-	sprintf(buffer, "%c[%dm", 0x1B, 0);
-	return buffer;
-}
+	Call call(*impl);
+	double start = Now();
 
-String FgRed() { return FgOn(160); }
-String FgBlu() { return FgOn(129); }
-String FgGrn() { return FgOn(150); }
-String FgYlw() { return FgOn(190); }
-String FgSky() { return FgOn(153); }
-String FgOrg() { return FgOn(214); }
+	VecP projects;
+	VecJ jobs;
+	int nSpawn = PlanCall(targets, projects, jobs);
 
-String Dashes(int n)
-{
-	return String(n, '-');
-}
+	Result result;
+	result.jobs = ApiJobs(jobs);
 
-String Star()
-{
-	return FgSky() + "* " + FgOff();
+	SetS failedOutputs;
+	bool failed = BuildJobs(projects, jobs, nSpawn, start, failedOutputs, result.stats);
+
+	result.ok = !failed && failedOutputs.empty();
+	result.failed.assign(failedOutputs.begin(), failedOutputs.end());
+	result.log = CapturedLog();
+
+	return result;
 }
 
-void Display(const String& label, const String& target, const String& detail)
+// Remove Outputs
+void bake::Context::Clean()
 {
-	std::cout << Prefix
-			  << FgBlu() << label  << ": " << FgOff()
-			  << FgYlw() << target << " (" << FgOff()
-			  << FgGrn() << detail         << FgOff()
-			  << FgYlw()           << ")"  << FgOff()
-			  << std::endl;
-}
+	Call call(*impl);
 
+	VecP projects;
+	LoadProjects(GetOpt("r"), projects);
 
+	for (VecP::iterator p = projects.begin(); p != projects.end(); ++p)
+	{
+		UseProject(*p);
+		CleanProject();
+	}
+}
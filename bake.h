@@ -0,0 +1,114 @@
+#ifndef BAKE_H
+#define BAKE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+
+/////////////
+// libbake //
+/////////////
+
+// Recipe Loading, Dependency Analysis, Up-to-Date Checks and Builds, In-Process
+//
+// Built From bake.cpp Without Its main (build.sh Makes libbake.a):
+//
+//     g++ -c -DBAKE_LIBRARY bake.cpp -o libbake.o && ar rcs libbake.a libbake.o
+//
+// Each Context is an Independent Build of a Directory (Its Own Options, and Its Own
+// Path, Stat and Include Caches, Kept Warm Between Calls; Files Changed Meanwhile are
+// Rescanned). A Call Enters the Context's Directory and Captures Standard Output and
+// Error (Including That of Forked Jobs) For Its Duration. Calls Run One at a Time, and a
+// Build Waits For Any Child Process of the Host, So Hosts Shouldn't Reap Children Meanwhile.
+
+namespace bake
+{
+	// Error (What bake Prints Before Exiting on the Command Line)
+	struct Error : std::runtime_error
+	{
+		Error(const std::string& what) : std::runtime_error(what) {}
+	};
+
+	// Options of a Context
+	struct Options
+	{
+		std::string              recipe;     // Recipe File (Default is Recipe.cfg)
+		std::string              workspace;  // Workspace File (Every Project Together, Instead of the Recipe)
+		int                      jobs;       // Spawn Size (0 is the CPU Limit)
+		std::vector<std::string> flags;      // Other Command-Line Options Without the Dash ("lto=thin", "fingerprint")
+
+		Options() : jobs(1) {}
+	};
+
+	// Recipe (One Project)
+	struct Recipe
+	{
+		std::string                                      name;         // Name (Workspace Projects)
+		std::string                                      dir;          // Directory (Absolute in a Workspace, Else Empty)
+		std::string                                      file;         // Recipe File
+		std::vector<std::vector<std::string> >           lines;        // Lines (Key Then Values, Variables Substituted)
+		std::map<std::string, std::vector<std::string> > variables;    // Variables
+		std::vector<std::string>                         includeDirs;  // Include Directories
+		std::vector<std::string>                         deps;         // Projects Linked Against (Names)
+	};
+
+	// Job (One Command of the Build Graph)
+	struct Job
+	{
+		std::string              output;   // Output (Absolute in a Workspace)
+		std::string              source;   // Source (Empty for Libraries)
+		std::string              command;  // Command
+		std::string              kind;     // compile or link
+		std::string              dir;      // Directory It Runs In (Empty is the Context's)
+		std::string              reason;   // Why It Runs
+		std::vector<std::string> after;    // Outputs It Waits For
+	};
+
+	// Build Result
+	struct Result
+	{
+		bool                          ok;      // Every Job Built and No Project Failed
+		std::vector<Job>              jobs;    // Jobs Scheduled
+		std::vector<std::string>      failed;  // Outputs That Failed to Build
+		std::map<std::string, double> stats;   // Run Record (wall, rebuilt, cacheHit, cutOff, ...)
+		std::string                   log;     // Output of the Build (No Colors)
+
+		Result() : ok(false) {}
+	};
+
+	// Context (Errors Throw bake::Error)
+	class Context
+	{
+	public:
+		Context(const std::string& dir, const Options& options = Options());
+		~Context();
+
+		// Load Recipes (Every Project of a Workspace in Dependency Order, Else the One Recipe)
+		std::vector<Recipe> Recipes();
+
+		// Include Closure of a Source or Header (Files Found in the Include Directories)
+		std::vector<std::string> Includes(const std::string& file);
+
+		// Jobs That Would Run, and Why (Only Those of the Targets and Their Inputs, When Given)
+		std::vector<Job> Plan(const std::vector<std::string>& targets = std::vector<std::string>());
+
+		// Build and Run Unit-Tests (Only the Targets and Their Inputs, When Given)
+		Result Build(const std::vector<std::string>& targets = std::vector<std::string>());
+
+		// Remove Outputs
+		void Clean();
+
+		// State (Defined in bake.cpp)
+		struct Impl;
+
+	private:
+		Impl* impl;
+
+		// Not Copyable
+		Context(const Context&);
+		Context& operator=(const Context&);
+	};
+}
+
+#endif
@@ -1 +1,4 @@
 g++ bake.cpp -o bake
+ln -sf bake bake-worker
+ln -sf bake bake-cache
+g++ -c -DBAKE_LIBRARY bake.cpp -o libbake.o && ar rcs libbake.a libbake.o